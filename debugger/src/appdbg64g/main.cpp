@@ -7,6 +7,7 @@
 
 #include "api_core.h"
 #include "iservice.h"
+#include "ihap.h"
 #include "coreservices/iudp.h"
 #include "coreservices/ithread.h"
 /** Plugin verification */
@@ -23,28 +24,56 @@ const char *default_config =
   "'GlobalSettings':{"
     "'SimEnable':true,"
     "'GUI':false,"
+    "'InitThreads':4,"
+    "'ExecutorThreads':4,"
     "'ScriptFile':''"
   "},"
   "'Services':["
+    "{'Class':'ReactorServiceClass','Instances':["
+          "{'Name':'reactor0','Attr':["
+                "['LogLevel',1]]}]},"
     "{'Class':'EdclServiceClass','Instances':["
           "{'Name':'edcltap','Attr':["
                 "['LogLevel',1],"
                 "['Transport','udpedcl'],"
-                "['seq_cnt',0]]}]},"
+                "['seq_cnt',0],"
+                "['PayloadMax',32],"
+                "['Window',1]]}]},"
+    "{'Class':'BusTapServiceClass','Instances':["
+          "{'Name':'bustap0','Attr':["
+                "['LogLevel',1],"
+                "['Bus','axi0'],"
+                "['HwTap','edcltap']]}]},"
+    "{'Class':'TapCacheServiceClass','Instances':["
+          "{'Name':'tapcache0','Attr':["
+                "['LogLevel',1],"
+                "['Tap','bustap0'],"
+                "['LineSize',64],"
+                "['MaxLines',1024],"
+                "['HaltStatusAddr',0x80090000],"
+                "['Regions',[[0x00000000,0x2000],[0x00100000,0x40000],"
+                            "[0x10000000,0x80000],[0x80090400,0x180]]]"
+                "]}]},"
     "{'Class':'UdpServiceClass','Instances':["
           "{'Name':'udpboard','Attr':["
                 "['LogLevel',1],"
-                "['Timeout',0x190]]},"
+                "['Timeout',0x190],"
+                "['Reactor','reactor0']]},"
           "{'Name':'udpedcl','Attr':["
                 "['LogLevel',1],"
                 "['Timeout',0x3e8],"
+                "['Reactor','reactor0'],"
                 "['HostIP','192.168.0.53'],"
                 "['BoardIP','192.168.0.51']]}]},"
     "{'Class':'ElfLoaderServiceClass','Instances':["
           "{'Name':'loader0','Attr':["
                 "['LogLevel',4],"
-                "['Tap','edcltap'],"
-                "['VerifyEna',true]]}]},"
+                "['Tap','tapcache0'],"
+                "['VerifyEna',true],"
+                "['DeltaLoad',false],"
+                "['PageSize',4096],"
+                "['CrcDsuAddress',0x80090000],"
+                "['TrustCache',false]]}]},"
     "{'Class':'ConsoleServiceClass','Instances':["
           "{'Name':'console0','Attr':["
                 "['LogLevel',4],"
@@ -53,6 +82,7 @@ const char *default_config =
                 "['StepQueue','core0'],"
                 "['Signals','gpio0'],"
                 "['HistorySize',64],"
+                "['Reactor','reactor0'],"
                 "['History',["
                      "'csr MCPUID',"
                      "'csr MTIME',"
@@ -64,7 +94,7 @@ const char *default_config =
           "{'Name':'cmd0','Attr':["
                 "['LogLevel',4],"
                 "['Console',['console0','gui0']],"
-                "['Tap','edcltap'],"
+                "['Tap','tapcache0'],"
                 "['Loader','loader0'],"
                 "['RegNames',[['zero',0],['ra',1],['sp',2],['gp',3],"
                             "['tp',4],['t0',5],['t1',6],['t2',7],"
@@ -90,7 +120,10 @@ const char *default_config =
                 "['LogLevel',4],"
                 "['Bus','axi0'],"
                 "['ListExtISA',['I','M','A']],"
-                "['FreqHz',60000000]"
+                "['FreqHz',60000000],"
+                "['IdleSkip',true],"
+                "['SpeedMode','max'],"
+                "['TraceSize',1024]"
                 "]}]},"
     "{'Class':'MemorySimClass','Instances':["
           "{'Name':'bootrom0','Attr':["
@@ -144,7 +177,8 @@ const char *default_config =
                 "['LogLevel',1],"
                 "['BaseAddress',0x80080000],"
                 "['Length',0x20000],"
-                "['HostIO','core0']"
+                "['HostIO','core0'],"
+                "['Bus','axi0']"
                 "]}]},"
     "{'Class':'GNSSStubClass','Instances':["
           "{'Name':'gnss0','Attr':["
@@ -195,7 +229,7 @@ const char *default_config =
                 "{'Name':'gui0','Attr':["
                 "['LogLevel',4],"
                 "['GuiConfig',[]],"
-                "['Tap','edcltap']"
+                "['Tap','tapcache0']"
                 "]}]},"
     "{'Class':'BoardSimClass','Instances':["
           "{'Name':'boardsim','Attr':["
@@ -207,6 +241,33 @@ const char *default_config =
 static char cfgbuf[1<<16];
 static AttributeType Config;
 
+/**
+ * @brief Connect simulated board to the EDCL debugger transport.
+ * @details Hap is registered before the configuration so it is triggered
+ *          before any other 'ConfigDone' listener (console script) and
+ *          doesn't depend on the services post-initialization order.
+ */
+class SimConnectHap : public IHap {
+public:
+    SimConnectHap() : IHap(HAP_ConfigDone) {}
+
+    virtual void hapTriggered(IFace *isrc, EHapType type, 
+                              const char *descr) {
+        IUdp *iudp1 = static_cast<IUdp *>
+                (RISCV_get_service_iface("udpboard", IFACE_UDP));
+        IUdp *iudp2 = static_cast<IUdp *>
+                (RISCV_get_service_iface("udpedcl", IFACE_UDP));
+        if (!iudp1 || !iudp2) {
+            return;
+        }
+
+        AttributeType t1 = iudp1->getConnectionSettings();
+        iudp2->setTargetSettings(&t1);
+        t1 = iudp2->getConnectionSettings();
+        iudp1->setTargetSettings(&t1);
+    }
+};
+
 const AttributeType *getConfigOfService(const AttributeType &cfg, 
                                         const char *name) {
     const AttributeType &serv = cfg["Services"];
@@ -268,21 +329,14 @@ int main(int argc, char* argv[]) {
     Config["GlobalSettings"]["GUI"].make_boolean(!disableGui);
     Config["GlobalSettings"]["ScriptFile"] = scriptFile;
 
-    RISCV_set_configuration(&Config);
-   
     // Connect simulator to the EDCL debugger if enabled:
+    SimConnectHap simConnect;
     if (!disableSim) {
-        IUdp *iudp1 = static_cast<IUdp *>
-                (RISCV_get_service_iface("udpboard", IFACE_UDP));
-        IUdp *iudp2 = static_cast<IUdp *>
-                (RISCV_get_service_iface("udpedcl", IFACE_UDP));
-
-        AttributeType t1 = iudp1->getConnectionSettings();
-        iudp2->setTargetSettings(&t1);
-        t1 = iudp2->getConnectionSettings();
-        iudp1->setTargetSettings(&t1);
+        RISCV_register_hap(static_cast<IHap *>(&simConnect));
     }
 
+    RISCV_set_configuration(&Config);
+
     IService *itst = static_cast<IService *>(RISCV_get_service("example1"));
     if (itst == NULL) {
         /**
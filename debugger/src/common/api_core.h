@@ -211,6 +211,22 @@ IFace *RISCV_get_class(const char *name);
 IFace *RISCV_create_service(IFace *iclass, const char *name, 
                                         AttributeType *args);
 
+/**
+ * @brief Get unique integer identifier of the string.
+ * @details Equal strings always return the same identifier so it can be used
+ *          as a key in the hash tables instead of the string comparision.
+ *          Core interns service names on registration only.
+ */
+int RISCV_intern_name(const char *name);
+
+/**
+ * @brief Version of the services registry.
+ * @details Incremented on each service creation. Callers keep results of
+ *          RISCV_get_service() or RISCV_get_services_with_iface() as handles
+ *          and refresh them only when the version changes.
+ */
+int RISCV_get_registry_version();
+
 /**
  * @brief Get IService interface by its name.
  */
@@ -225,6 +241,8 @@ IFace *RISCV_get_service_iface(const char *servname, const char *facename);
 
 /**
  * @brief Get list of services implementing specific interface.
+ * @details Result is cached in the core and invalidated only when new
+ *          service is created.
  */
 void RISCV_get_services_with_iface(const char *iname, AttributeType *list);
 
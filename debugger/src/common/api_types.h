@@ -30,6 +30,7 @@
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
 #include <pthread.h>
+#include <semaphore.h>
 #include <fcntl.h>
 #include <termios.h>  // work with console
 #endif
@@ -46,9 +47,11 @@ namespace debugger {
         void *cond; // HANDLE = void*
         bool state;
     } event_def;
+    typedef void *semaphore_def; // HANDLE = void*
     typedef unsigned thread_return_t;
     typedef thread_return_t (__stdcall* lib_thread_func)(void *args);
 
+    #define THREAD_LOCAL __declspec(thread)
     #define RV_PRI64 "I64"
 #else /* Linux */
     typedef int socket_def;
@@ -60,9 +63,11 @@ namespace debugger {
         pthread_cond_t cond;
         bool state;
     } event_def;
+    typedef sem_t semaphore_def;
     typedef void *thread_return_t;
     typedef thread_return_t (*lib_thread_func)(void *args);
 
+    #define THREAD_LOCAL __thread
     # if defined(__WORDSIZE) && (__WORDSIZE == 64)
     #  define RV_PRI64 "l"
     # else
@@ -70,11 +75,20 @@ namespace debugger {
     # endif
 #endif
 
+/** Task function executed by the core thread pool. */
+typedef void (*lib_task_func)(void *args);
+
 typedef struct LibThreadType
 {
     lib_thread_func func;
     void *args;
     thread_def Handle;
+    /** Optional thread name visible in the system tools (or NULL). */
+    const char *name;
+    /** 0 = default scheduling; >0 = real-time; <0 = idle priority. */
+    int priority;
+    /** Bit mask of allowed host CPUs; 0 = any CPU. */
+    uint64_t affinity;
 } LibThreadType;
 
 }  // namespace debugger
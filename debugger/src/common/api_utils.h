@@ -66,11 +66,49 @@ void RISCV_event_close(event_def *ev);
 void RISCV_event_set(event_def *ev);
 void RISCV_event_clear(event_def *ev);
 void RISCV_event_wait(event_def *ev);
+/**
+ * @brief Wait event with timeout.
+ * @return 0 if event was set, 1 on timeout.
+ */
+int RISCV_event_wait_ms(event_def *ev, int ms);
+
+/** Counting semaphore with the initial value. */
+void RISCV_semaphore_create(semaphore_def *sem, int initial);
+void RISCV_semaphore_close(semaphore_def *sem);
+void RISCV_semaphore_post(semaphore_def *sem);
+void RISCV_semaphore_wait(semaphore_def *sem);
+/**
+ * @brief Decrement semaphore or wait with timeout.
+ * @return 0 if semaphore was decremented, 1 on timeout.
+ */
+int RISCV_semaphore_wait_ms(semaphore_def *sem, int ms);
+
+/**
+ * @brief Execute task on the shared core thread pool.
+ * @details Tasks submitted from the pool thread are put into its own queue,
+ *          idle threads steal tasks from the queues of the busy ones.
+ */
+void RISCV_submit(lib_task_func func, void *args);
+
+/**
+ * @brief Submit task into the thread pool after the specified delay.
+ * @return Timer identifier that can be used to cancel the task.
+ */
+uint64_t RISCV_schedule_after(int ms, lib_task_func func, void *args);
+
+/** Cancel task scheduled by RISCV_schedule_after if it wasn't started. */
+void RISCV_cancel_timer(uint64_t id);
 
 /** Memory allocator/de-allocator */
 void *RISCV_malloc(uint64_t sz);
 void RISCV_free(void *p);
 
+/**
+ * @brief CRC-32 (IEEE 802.3) of the buffer.
+ * @param[in] crc Result of the previous part or 0 for the first one.
+ */
+uint32_t RISCV_crc32(const void *buf, uint64_t sz, uint32_t crc);
+
 /** Get absolute directory where core library is placed. */
 int RISCV_get_core_folder(char *out, int sz);
 
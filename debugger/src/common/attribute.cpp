@@ -423,6 +423,9 @@ const char *string_to_attribute(const char *cfg,
         } else {
             char digits[32] = {0};
             int digits_cnt = 0;
+            if (pcur[0] == '-') {
+                digits[digits_cnt++] = *pcur++;
+            }
             if (pcur[0] == '0' && pcur[1] == 'x') {
                 pcur += 2;
                 digits[digits_cnt++] = '0';
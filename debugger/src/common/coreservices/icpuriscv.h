@@ -17,6 +17,13 @@ static const char *const IFACE_CPU_RISCV = "ICpuRiscV";
 
 static const uint64_t REG_INVALID = ~0;
 
+/** Executed instruction stored in the trace buffer. */
+struct CpuTraceEntryType {
+    uint64_t step;
+    uint64_t pc;
+    uint32_t instr;
+};
+
 class ICpuRiscV : public IFace {
 public:
     ICpuRiscV() : IFace(IFACE_CPU_RISCV) {}
@@ -34,6 +41,19 @@ public:
     virtual void addBreakpoint(uint64_t addr) =0;
     virtual void removeBreakpoint(uint64_t addr) =0;
     virtual void hitBreakpoint(uint64_t addr) =0;
+
+    /** Simulated time (step_cnt / FreqHz) to host wall time ratio */
+    virtual double getSimWallRatio() =0;
+    /** Pace simulation to the host wall clock or run at max speed */
+    virtual void setRealTime(bool en) =0;
+    virtual bool isRealTime() =0;
+
+    /** Capacity of the executed instructions ring, 0 = trace disabled */
+    virtual unsigned getTraceSize() =0;
+    /** Number of instructions traced since start */
+    virtual uint64_t getTraceCount() =0;
+    /** Stored entry, idx = 0 is the latest one. NULL if not stored. */
+    virtual const CpuTraceEntryType *getTraceEntry(unsigned idx) =0;
 };
 
 }  // namespace debugger
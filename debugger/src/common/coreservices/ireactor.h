@@ -0,0 +1,50 @@
+/**
+ * @file
+ * @copyright  Copyright 2016 GNSS Sensor Ltd. All right reserved.
+ * @author     Sergey Khabarov - sergeykhbr@gmail.com
+ * @brief      I/O events demultiplexer interface declaration.
+ */
+
+#ifndef __DEBUGGER_IREACTOR_H__
+#define __DEBUGGER_IREACTOR_H__
+
+#include "iface.h"
+#include "api_types.h"
+
+namespace debugger {
+
+static const char *const IFACE_REACTOR = "IReactor";
+static const char *const IFACE_REACTOR_LISTENER = "IReactorListener";
+
+class IReactorListener : public IFace {
+public:
+    IReactorListener() : IFace(IFACE_REACTOR_LISTENER) {}
+
+    /**
+     * @brief New input data available on the registered descriptor.
+     * @details Called from the reactor thread. Notification is edge
+     *          triggered so the listener must read all available data
+     *          before waiting the next one.
+     */
+    virtual void readyRead(socket_def fd) =0;
+};
+
+class IReactor : public IFace {
+public:
+    IReactor() : IFace(IFACE_REACTOR) {}
+
+    /**
+     * @brief Start waiting input on the descriptor.
+     * @return 0 on success or -1 if descriptor cannot be polled (not a
+     *         socket on Windows, regular file on Linux).
+     */
+    virtual int registerReadHandler(socket_def fd,
+                                    IReactorListener *ilistener) =0;
+
+    /** Stop waiting input. Should be called before closing descriptor. */
+    virtual void unregisterReadHandler(socket_def fd) =0;
+};
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_IREACTOR_H__
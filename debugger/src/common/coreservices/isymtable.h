@@ -0,0 +1,43 @@
+/**
+ * @file
+ * @copyright  Copyright 2016 GNSS Sensor Ltd. All right reserved.
+ * @author     Sergey Khabarov - sergeykhbr@gmail.com
+ * @brief      Symbol table interface of the loaded image.
+ */
+
+#ifndef __DEBUGGER_ISYMTABLE_H__
+#define __DEBUGGER_ISYMTABLE_H__
+
+#include "iface.h"
+#include <inttypes.h>
+
+namespace debugger {
+
+static const char *const IFACE_SYMBOL_TABLE = "ISymbolTable";
+
+class ISymbolTable : public IFace {
+public:
+    ISymbolTable() : IFace(IFACE_SYMBOL_TABLE) {}
+
+    /**
+     * @brief Find symbol containing the address.
+     * @param[out] offset Offset of the address from the symbol start.
+     * @return Symbol name or NULL. Name is valid until the next loading.
+     */
+    virtual const char *findSymbol(uint64_t addr, uint64_t *offset) =0;
+
+    /** @return true and symbol address if the name is defined. */
+    virtual bool findAddress(const char *name, uint64_t *addr) =0;
+
+    virtual unsigned getSymbolCount() =0;
+
+    /**
+     * @brief Find source line of the address in DWARF line table.
+     * @return File path or NULL. Path is valid until the next loading.
+     */
+    virtual const char *findLine(uint64_t addr, int *line) =0;
+};
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_ISYMTABLE_H__
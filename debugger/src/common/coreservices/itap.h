@@ -10,11 +10,31 @@
 
 #include "iface.h"
 #include "attribute.h"
+#include "api_core.h"
 #include <inttypes.h>
+#include <string.h>
 
 namespace debugger {
 
 static const char *const IFACE_TAP = "ITap";
+static const char *const IFACE_TAP_LISTENER = "ITapListener";
+
+/** One range of the scatter-gather TAP request. */
+struct TapRequestType {
+    uint64_t addr;
+    int bytes;
+    uint8_t *buf;
+    int rw;             // read = 0; write = 1; fill = 2 with buf[0] value
+    int result;         // transferred bytes, set on completion
+};
+
+class ITapListener : public IFace {
+public:
+    ITapListener() : IFace(IFACE_TAP_LISTENER) {}
+
+    /** All ranges of the submitted request were executed. */
+    virtual void tapCompleted(TapRequestType *reqs, int cnt) =0;
+};
 
 static const char *const ITap_brief = 
 "Test Access Point (TAP) software interface.";
@@ -33,6 +53,74 @@ public:
 
     virtual int read(uint64_t addr, int bytes, uint8_t *obuf) =0;
     virtual int write(uint64_t addr, int bytes, uint8_t *ibuf) =0;
+
+    /**
+     * @brief Set all bytes of the range to the value (.bss, heap).
+     * @details Default implementation repeats write() of one bounded chunk,
+     *          simulated bus fills memory without the transfer.
+     */
+    virtual int fill(uint64_t addr, int bytes, uint8_t val) {
+        uint8_t chunk[TAP_FILL_CHUNK_BYTES];
+        int done = 0;
+        memset(chunk, val, sizeof(chunk));
+        while (done < bytes) {
+            int sz = bytes - done;
+            if (sz > TAP_FILL_CHUNK_BYTES) {
+                sz = TAP_FILL_CHUNK_BYTES;
+            }
+            if (write(addr + done, sz, chunk) != sz) {
+                break;
+            }
+            done += sz;
+        }
+        return done;
+    }
+
+    /**
+     * @brief Asynchronous scatter-gather access.
+     * @details Ranges are executed in order of the list and the listener is
+     *          called from the core thread pool. Requests and buffers must
+     *          stay valid until then. Default implementation executes
+     *          blocking read()/write(), transports may override it to
+     *          execute all ranges with one transaction.
+     */
+    virtual void submit(TapRequestType *reqs, int cnt,
+                        ITapListener *ilistener) {
+        TapSubmitType *p = new TapSubmitType;
+        p->itap = this;
+        p->reqs = reqs;
+        p->cnt = cnt;
+        p->ilistener = ilistener;
+        RISCV_submit(runSubmit, p);
+    }
+
+protected:
+    static const int TAP_FILL_CHUNK_BYTES = 4096;
+
+    struct TapSubmitType {
+        ITap *itap;
+        TapRequestType *reqs;
+        int cnt;
+        ITapListener *ilistener;
+    };
+
+    static void runSubmit(void *args) {
+        TapSubmitType *p = reinterpret_cast<TapSubmitType *>(args);
+        for (int i = 0; i < p->cnt; i++) {
+            TapRequestType &r = p->reqs[i];
+            if (r.rw == 2) {
+                r.result = p->itap->fill(r.addr, r.bytes, r.buf[0]);
+            } else if (r.rw) {
+                r.result = p->itap->write(r.addr, r.bytes, r.buf);
+            } else {
+                r.result = p->itap->read(r.addr, r.bytes, r.buf);
+            }
+        }
+        if (p->ilistener) {
+            p->ilistener->tapCompleted(p->reqs, p->cnt);
+        }
+        delete p;
+    }
 };
 
 }  // namespace debugger
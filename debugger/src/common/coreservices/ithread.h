@@ -9,6 +9,8 @@
 #define __DEBUGGER_ITHREAD_H__
 
 #include "iface.h"
+#include "attribute.h"
+#include "iservice.h"
 #include "api_core.h"
 
 namespace debugger {
@@ -21,17 +23,27 @@ public:
         loopEnable_ = false;
         interrupt_ = false;
         threadInit_.Handle = 0;
+        affinity_.make_list(0);
+        priority_.make_int64(0);
+        threadName_.make_string("");
     }
 
     /** create and start seperate thread */
     virtual bool run() {
-        loopEnable_ = false;
+        // Enable loop before start, otherwise thread may exit immediately
+        loopEnable_ = true;
         threadInit_.func = (lib_thread_func)runThread;
         threadInit_.args = this;
+        threadInit_.name = threadName_.size() ? threadName_.to_string() : 0;
+        threadInit_.priority = static_cast<int>(priority_.to_int64());
+        threadInit_.affinity = 0;
+        for (unsigned i = 0; i < affinity_.size(); i++) {
+            threadInit_.affinity |= 1ull << (affinity_[i].to_uint64() & 0x3f);
+        }
         RISCV_thread_create(&threadInit_);
 
-        if (threadInit_.Handle) {
-            loopEnable_ = true;
+        if (!threadInit_.Handle) {
+            loopEnable_ = false;
         }
         return loopEnable_;
     }
@@ -53,6 +65,17 @@ public:
     virtual bool isEnabled() { return loopEnable_ && !interrupt_; }
 
 protected:
+    /**
+     * @brief Register scheduling attributes 'Affinity', 'Priority' and
+     *        'ThreadName' in the service owning the thread.
+     */
+    void registerThreadAttributes(IService *isrv) {
+        isrv->registerAttribute("Affinity", &affinity_);
+        isrv->registerAttribute("Priority", &priority_);
+        isrv->registerAttribute("ThreadName", &threadName_);
+        threadName_.make_string(isrv->getObjName());
+    }
+
     /** working cycle function */
     virtual void busyLoop() =0;
 
@@ -64,6 +87,9 @@ protected:
     volatile bool loopEnable_;
     volatile bool interrupt_;
     LibThreadType threadInit_;
+    AttributeType affinity_;
+    AttributeType priority_;
+    AttributeType threadName_;
 };
 
 }  // namespace debugger
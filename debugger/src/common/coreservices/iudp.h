@@ -16,6 +16,13 @@ namespace debugger {
 
 static const char *const IFACE_UDP = "IUdp";
 
+/** Datagram descriptor used by the batch transfer methods. */
+struct UdpBatchItemType {
+    uint8_t *buf;   // caller's datagram buffer
+    int size;       // datagram length to send or buffer size to receive
+    int len;        // sent/received number of bytes
+};
+
 class IUdp : public IFace {
 public:
     IUdp() : IFace(IFACE_UDP) {}
@@ -41,6 +48,20 @@ public:
     /** Read datagram buffer. */
     virtual int readData(const uint8_t *buf, int maxlen) =0;
 
+    /**
+     * @brief Send several datagrams with a single system call if possible.
+     * @return Number of sent datagrams or -1 on error.
+     */
+    virtual int sendDataBatch(UdpBatchItemType *items, int cnt) =0;
+
+    /**
+     * @brief Receive several datagrams directly into the caller's buffers.
+     * @details Only the first datagram is waited (with the socket timeout),
+     *          the others are taken if they were already received.
+     * @return Number of received datagrams, 0 on timeout or -1 on error.
+     */
+    virtual int readDataBatch(UdpBatchItemType *items, int cnt) =0;
+
     /** Register listener of the received data. */
     virtual int registerListener(IRawListener *ilistener) =0;
 };
@@ -18,7 +18,8 @@ static const char *const IFACE_HAP = "IHap";
 enum EHapType {
     HAP_All,
     HAP_ConfigDone,
-    HAP_BreakSimulation
+    HAP_BreakSimulation,
+    HAP_Halt
 };
 
 class IHap : public IFace {
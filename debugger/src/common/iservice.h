@@ -96,6 +96,11 @@ public:
 
     virtual const char *getObjName() { return obj_name_; }
 
+    /** Direct access to 'LogLevel' attribute without name look-up. */
+    virtual int getLogLevel() {
+        return static_cast<int>(logLevel_.to_int64());
+    }
+
     virtual AttributeType getConfiguration() {
         AttributeType ret(Attr_Dict);
         ret["Name"] = AttributeType(getObjName());
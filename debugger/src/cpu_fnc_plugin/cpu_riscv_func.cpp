@@ -14,6 +14,7 @@ namespace debugger {
 CpuRiscV_Functional::CpuRiscV_Functional(const char *name)  
     : IService(name), IHap(HAP_ConfigDone) {
     registerInterface(static_cast<IThread *>(this));
+    registerThreadAttributes(this);
     registerInterface(static_cast<ICpuRiscV *>(this));
     registerInterface(static_cast<IClock *>(this));
     registerInterface(static_cast<IHostIO *>(this));
@@ -21,10 +22,16 @@ CpuRiscV_Functional::CpuRiscV_Functional(const char *name)
     registerAttribute("Bus", &bus_);
     registerAttribute("ListExtISA", &listExtISA_);
     registerAttribute("FreqHz", &freqHz_);
+    registerAttribute("IdleSkip", &idleSkip_);
+    registerAttribute("SpeedMode", &speedMode_);
+    registerAttribute("TraceSize", &traceSize_);
 
     bus_.make_string("");
     listExtISA_.make_list(0);
     freqHz_.make_uint64(1);
+    idleSkip_.make_boolean(true);
+    speedMode_.make_string("max");
+    traceSize_.make_uint64(0);
 
     stepPreQueued_.make_list(0);
     stepQueue_.make_list(16);   /** it will be auto reallocated if needed */
@@ -34,15 +41,27 @@ CpuRiscV_Functional::CpuRiscV_Functional(const char *name)
 
     RISCV_mutex_init(&mutexStepQueue_);
     RISCV_event_create(&config_done_, "config_done");
+    RISCV_event_create(&wake_, "cpu_wake");
     RISCV_register_hap(static_cast<IHap *>(this));
     cpu_context_.csr[CSR_mreset]   = 0;
     dbg_state_ = STATE_Normal;
     last_hit_breakpoint_ = ~0;
+    idle_steps_ = 0;
+    loop_valid_ = false;
+    realtime_ = false;
+    sim_wall_ratio_ = 0;
+    trace_ = 0;
+    trace_mask_ = 0;
+    trace_cnt_ = 0;
     reset();
 }
 
 CpuRiscV_Functional::~CpuRiscV_Functional() {
+    if (trace_) {
+        delete [] trace_;
+    }
     RISCV_event_close(&config_done_);
+    RISCV_event_close(&wake_);
     RISCV_mutex_destroy(&mutexStepQueue_);
 }
 
@@ -74,6 +93,29 @@ void CpuRiscV_Functional::postinitService() {
         }
     }
 
+    realtime_ = strcmp(speedMode_.to_string(), "realtime") == 0;
+    if (!realtime_ && strcmp(speedMode_.to_string(), "max") != 0) {
+        RISCV_error("Unknown SpeedMode '%s', use 'max' or 'realtime'",
+                    speedMode_.to_string());
+    }
+
+    // Trace size is rounded up to power of 2 to index ring by mask
+    uint64_t trace_sz = traceSize_.to_uint64();
+    if (trace_sz > TRACE_SIZE_MAX) {
+        RISCV_error("TraceSize %" RV_PRI64 "d exceeds maximum %d",
+                    trace_sz, TRACE_SIZE_MAX);
+        trace_sz = TRACE_SIZE_MAX;
+    }
+    if (trace_sz) {
+        unsigned sz = 1;
+        while (sz < trace_sz) {
+            sz <<= 1;
+        }
+        trace_ = new CpuTraceEntryType[sz];
+        memset(trace_, 0, sz * sizeof(CpuTraceEntryType));
+        trace_mask_ = sz - 1;
+    }
+
     // Get global settings:
     const AttributeType *glb = RISCV_get_global_settings();
     if ((*glb)["SimEnable"].to_bool()) {
@@ -86,6 +128,10 @@ void CpuRiscV_Functional::postinitService() {
 
 void CpuRiscV_Functional::predeleteService() {
     stop();
+    if (idle_steps_) {
+        RISCV_info("Idle steps skipped: %" RV_PRI64 "d of %" RV_PRI64 "d",
+                    idle_steps_, getStepCounter());
+    }
 }
 
 void CpuRiscV_Functional::hapTriggered(IFace *isrc, EHapType type,
@@ -96,13 +142,114 @@ void CpuRiscV_Functional::hapTriggered(IFace *isrc, EHapType type,
 void CpuRiscV_Functional::busyLoop() {
     RISCV_event_wait(&config_done_);
 
+    resetSpeed();
     while (isEnabled()) {
+        if (isIdle()) {
+            /**
+             * Clear before re-checking so that any go/step/reset or new
+             * step callback issued after the check sets the event again.
+             */
+            RISCV_event_clear(&wake_);
+            if (isIdle()) {
+                RISCV_event_wait(&wake_);
+                // Time spent in halted state isn't simulation time
+                resetSpeed();
+                continue;
+            }
+        }
         updatePipeline();
+        if (getpContext()->step_cnt >= speed_next_step_) {
+            updateSpeed();
+        }
     }
     loopEnable_ = false;
     threadInit_.Handle = 0;
 }
 
+/**
+ * Halted CPU doesn't increment step counter so the only work left is
+ * reset request and step-queue events registered since the last pass.
+ */
+bool CpuRiscV_Functional::isIdle() {
+    return dbg_state_ == STATE_Halted
+        && !getpContext()->csr[CSR_mreset]
+        && stepPreQueued_len_ == 0
+        && isEnabled();
+}
+
+void CpuRiscV_Functional::resetSpeed() {
+    uint64_t t = RISCV_get_time_ms();
+    pace_step_ = ratio_step_ = getpContext()->step_cnt;
+    pace_ms_ = ratio_ms_ = t;
+    speed_next_step_ = pace_step_;
+}
+
+/**
+ * @brief Check wall clock once per 1 ms of simulated time.
+ * @details In real-time mode the thread sleeps while simulated time
+ *          (step_cnt / FreqHz) is ahead of the host clock. Idle skip makes
+ *          idle firmware cost nothing in this mode.
+ */
+void CpuRiscV_Functional::updateSpeed() {
+    uint64_t step_cnt = getpContext()->step_cnt;
+    uint64_t freq = freqHz_.to_uint64();
+    uint64_t t = RISCV_get_time_ms();
+    if (freq == 0) {
+        freq = 1;
+    }
+
+    uint64_t wall_ms = t - ratio_ms_;
+    if (wall_ms >= SPEED_RATIO_WINDOW_MS) {
+        sim_wall_ratio_ = (static_cast<double>(step_cnt - ratio_step_)
+                        / static_cast<double>(freq))
+                        / (0.001 * static_cast<double>(wall_ms));
+        ratio_step_ = step_cnt;
+        ratio_ms_ = t;
+    }
+
+    speed_next_step_ = step_cnt + (freq + 999) / 1000;
+    if (!realtime_) {
+        return;
+    }
+    uint64_t sim_ms = ((step_cnt - pace_step_) * 1000) / freq;
+    wall_ms = t - pace_ms_;
+    if (sim_ms > wall_ms) {
+        uint64_t ahead = sim_ms - wall_ms;
+        if (ahead > SPEED_SLEEP_MAX_MS) {
+            ahead = SPEED_SLEEP_MAX_MS;
+        }
+        // Any debugger request interrupts pacing
+        RISCV_event_clear(&wake_);
+        RISCV_event_wait_ms(&wake_, static_cast<int>(ahead));
+        /**
+         * Re-check on the next step when still ahead, otherwise host was
+         * slower than real time and there's no point to catch up.
+         */
+        speed_next_step_ = step_cnt;
+    } else if (wall_ms - sim_ms > SPEED_SLEEP_MAX_MS) {
+        pace_step_ = step_cnt;
+        pace_ms_ = t;
+    }
+}
+
+void CpuRiscV_Functional::setRealTime(bool en) {
+    speedMode_.make_string(en ? "realtime" : "max");
+    resetSpeed();
+    realtime_ = en;
+    wakeup();
+}
+
+void CpuRiscV_Functional::stop() {
+    loopEnable_ = false;
+    wakeup();
+    IThread::stop();
+}
+
+void CpuRiscV_Functional::breakSignal() {
+    IThread::breakSignal();
+    wakeup();
+}
+
 void CpuRiscV_Functional::updatePipeline() {
     IInstruction *instr;
     CpuContextType *pContext = getpContext();
@@ -122,6 +269,9 @@ void CpuRiscV_Functional::updatePipeline() {
 
     instr = decodeInstruction(cacheline_);
     if (isRunning()) {
+        if (trace_) {
+            traceInstruction();
+        }
         last_hit_breakpoint_ = ~0;
         if (instr) {
             executeInstruction(instr, cacheline_);
@@ -137,7 +287,107 @@ void CpuRiscV_Functional::updatePipeline() {
 
     queueUpdate();
 
+    uint64_t npc = pContext->npc;
     handleTrap();
+
+    // Stepping executes every instruction, skip only free running loops
+    if (dbg_state_ == STATE_Normal && instr && idleSkip_.to_bool()) {
+        if (npc != pContext->npc) {
+            loop_valid_ = false;
+        } else {
+            trackIdleLoop();
+        }
+    }
+}
+
+/**
+ * @brief Detect idle loop and fast-forward to the next step-queue event.
+ * @details Loop head is the target of a backward JAL or branch. When
+ *          execution comes back to the same head with the same integer
+ *          registers and the iteration hasn't changed anything outside of
+ *          the dead stack area below the head stack pointer, the next
+ *          iteration is identical and only a step-queue event (interrupt,
+ *          device state) can break the loop. This covers WFI, 'j .' and
+ *          polling loops like the Zephyr idle thread.
+ */
+void CpuRiscV_Functional::trackIdleLoop() {
+    CpuContextType *pContext = getpContext();
+    if (hasSideEffect()) {
+        loop_dirty_ = true;
+    }
+    // Loop back-edge is JAL or a branch (or stalled WFI), not a return
+    uint32_t opcode = cacheline_[0] & 0x7f;
+    if (pContext->npc > pContext->pc
+        || (opcode != 0x6f && opcode != 0x63
+            && cacheline_[0] != 0x10200073)) {
+        return;
+    }
+    if (loop_valid_ && !loop_dirty_ && pContext->npc == loop_head_
+        && memcmp(loop_regs_, pContext->regs, sizeof(loop_regs_)) == 0) {
+        skipIdleSteps();
+        return;
+    }
+    loop_head_ = pContext->npc;
+    memcpy(loop_regs_, pContext->regs, sizeof(loop_regs_));
+    loop_dirty_ = false;
+    loop_valid_ = true;
+}
+
+bool CpuRiscV_Functional::hasSideEffect() {
+    CpuContextType *pContext = getpContext();
+    uint32_t instr = cacheline_[0];
+    uint32_t funct3 = (instr >> 12) & 0x7;
+    uint32_t rs1 = (instr >> 15) & 0x1f;
+    switch (instr & 0x7f) {
+    case 0x23:      // STORE
+    case 0x27: {    // STORE-FP
+        int64_t off = static_cast<int32_t>(instr & 0xfe000000) >> 20;
+        off |= (instr >> 7) & 0x1f;
+        uint64_t addr = pContext->regs[rs1] + off;
+        // Stack below loop head is scratch of the called functions
+        return addr + (1ull << (funct3 & 0x3)) > loop_regs_[2]
+            || addr < loop_regs_[2] - IDLE_STACK_SCRATCH;
+    }
+    case 0x2f:      // AMO
+        return true;
+    case 0x73:      // SYSTEM
+        if (funct3 == 0) {
+            return instr != 0x10200073;     // all except WFI
+        }
+        // CSRRS/CSRRC with rs1/zimm = 0 are plain reads
+        return (funct3 & 0x3) == 1 || rs1 != 0;
+    default:;
+    }
+    return false;
+}
+
+void CpuRiscV_Functional::skipIdleSteps() {
+    CpuContextType *pContext = getpContext();
+    uint64_t ev_time;
+    uint64_t next = ~0ull;
+
+    if (stepPreQueued_len_) {
+        copyPreQueued();
+    }
+    for (unsigned i = 0; i < stepQueue_len_; i++) {
+        ev_time = stepQueue_[i][Queue_Time].to_uint64();
+        if (ev_time < next) {
+            next = ev_time;
+        }
+    }
+    if (next == ~0ull) {
+        // Nothing is scheduled: interrupt may come only from outside
+        return;
+    }
+    /**
+     * Stop one step before the deadline so that loop is executed once more
+     * and the event is processed by queueUpdate() exactly as without skip.
+     */
+    next--;
+    if (next > pContext->step_cnt) {
+        idle_steps_ += next - pContext->step_cnt;
+        pContext->step_cnt = next;
+    }
 }
 
 void CpuRiscV_Functional::updateState() {
@@ -187,6 +437,7 @@ void CpuRiscV_Functional::reset() {
     mstat.bits.IE = 0;
     mstat.bits.PRV = PRV_LEVEL_M;           // Current privilege level
     pContext->csr[CSR_mstatus] = mstat.value;
+    loop_valid_ = false;
 }
 
 void CpuRiscV_Functional::handleTrap() {
@@ -427,6 +678,7 @@ void CpuRiscV_Functional::registerStepCallback(IClockListener *cb,
     stepPreQueued_[stepPreQueued_len_] = item;
     stepPreQueued_len_++;
     RISCV_mutex_unlock(&mutexStepQueue_);
+    wakeup();
 }
 
 void CpuRiscV_Functional::copyPreQueued() {
@@ -446,6 +698,7 @@ void CpuRiscV_Functional::copyPreQueued() {
 
 uint64_t CpuRiscV_Functional::write(uint16_t adr, uint64_t val) {
     writeCSR(adr, val, getpContext());
+    wakeup();
     return 0;
 }
 
@@ -458,22 +711,34 @@ void CpuRiscV_Functional::halt() {
     CpuContextType *pContext = getpContext();
     char reason[256];
     dbg_state_ = STATE_Halted;
+    loop_valid_ = false;
     RISCV_sprintf(reason, sizeof(reason), 
                 "[%" RV_PRI64 "d] pc:%016" RV_PRI64 "x: %08x \t CPU halted",
                 getStepCounter(), pContext->pc, cacheline_[0]);
 
     RISCV_printf0("[%" RV_PRI64 "d] pc:%016" RV_PRI64 "x: %08x \t CPU halted",
         getStepCounter(), pContext->pc, cacheline_[0]);
+    RISCV_trigger_hap(getInterface(IFACE_SERVICE), HAP_Halt, reason);
 }
 
 void CpuRiscV_Functional::go() {
     dbg_state_ = STATE_Normal;
+    wakeup();
 }
 
 void CpuRiscV_Functional::step(uint64_t cnt) {
     CpuContextType *pContext = getpContext();
     dbg_step_cnt_ = pContext->step_cnt + cnt;
     dbg_state_ = STATE_Stepping;
+    loop_valid_ = false;
+    wakeup();
+}
+
+const CpuTraceEntryType *CpuRiscV_Functional::getTraceEntry(unsigned idx) {
+    if (!trace_ || idx > trace_mask_ || idx >= trace_cnt_) {
+        return NULL;
+    }
+    return &trace_[(trace_cnt_ - 1 - idx) & trace_mask_];
 }
 
 uint64_t CpuRiscV_Functional::getReg(uint64_t idx) {
@@ -527,10 +792,12 @@ void CpuRiscV_Functional::hitBreakpoint(uint64_t addr) {
         return;
     }
     dbg_state_ = STATE_Halted;
+    loop_valid_ = false;
     last_hit_breakpoint_ = addr;
 
     RISCV_printf0("[%" RV_PRI64 "d] pc:%016" RV_PRI64 "x: %08x \t stop on breakpoint",
         getStepCounter(), pContext->pc, cacheline_[0]);
+    RISCV_trigger_hap(getInterface(IFACE_SERVICE), HAP_Halt, "Breakpoint");
 }
 
 }  // namespace debugger
@@ -49,6 +49,12 @@ public:
     virtual void addBreakpoint(uint64_t addr);
     virtual void removeBreakpoint(uint64_t addr);
     virtual void hitBreakpoint(uint64_t addr);
+    virtual double getSimWallRatio() { return sim_wall_ratio_; }
+    virtual void setRealTime(bool en);
+    virtual bool isRealTime() { return realtime_; }
+    virtual unsigned getTraceSize() { return trace_ ? trace_mask_ + 1 : 0; }
+    virtual uint64_t getTraceCount() { return trace_cnt_; }
+    virtual const CpuTraceEntryType *getTraceEntry(unsigned idx);
 
     /** IHostIO */
     virtual uint64_t write(uint16_t adr, uint64_t val);
@@ -64,6 +70,10 @@ public:
     /** IHap */
     virtual void hapTriggered(IFace *isrc, EHapType type, const char *descr);
 
+    /** IThread interface */
+    virtual void stop();
+    virtual void breakSignal();
+
 protected:
     /** IThread interface */
     virtual void busyLoop();
@@ -73,6 +83,19 @@ private:
     uint32_t hash32(uint32_t val) { return (val >> 2) & 0x1f; }
 
     void updatePipeline();
+    bool isIdle();
+    void trackIdleLoop();
+    bool hasSideEffect();
+    void skipIdleSteps();
+    void updateSpeed();
+    void resetSpeed();
+    void traceInstruction() {
+        CpuTraceEntryType &e = trace_[trace_cnt_++ & trace_mask_];
+        e.step = cpu_context_.step_cnt;
+        e.pc = cpu_context_.pc;
+        e.instr = cacheline_[0];
+    }
+    void wakeup() { RISCV_event_set(&wake_); }
 
     void updateState();
     bool isRunning();
@@ -89,7 +112,11 @@ private:
     AttributeType bus_;
     AttributeType listExtISA_;
     AttributeType freqHz_;
+    AttributeType idleSkip_;
+    AttributeType speedMode_;
+    AttributeType traceSize_;
     event_def config_done_;
+    event_def wake_;    // signalled on any change that may end halted idle
     uint64_t last_hit_breakpoint_;
 
     uint32_t cacheline_[512/4];
@@ -116,6 +143,30 @@ private:
         STATE_Stepping
     } dbg_state_;
     uint64_t dbg_step_cnt_;
+    // Idle loop detection:
+    static const uint64_t IDLE_STACK_SCRATCH = 4096;
+    uint64_t idle_steps_;   // steps skipped by idle fast-forward
+    bool loop_valid_;
+    bool loop_dirty_;
+    uint64_t loop_head_;
+    uint64_t loop_regs_[32];
+
+    // Speed control:
+    static const uint64_t SPEED_RATIO_WINDOW_MS = 500;
+    static const int SPEED_SLEEP_MAX_MS = 100;
+    bool realtime_;
+    uint64_t speed_next_step_;  // next step to check wall clock
+    uint64_t pace_step_;        // real-time pacing origin
+    uint64_t pace_ms_;
+    uint64_t ratio_step_;       // ratio measurement window origin
+    uint64_t ratio_ms_;
+    double sim_wall_ratio_;
+
+    // Ring of the last executed instructions, DSU window size is the limit:
+    static const unsigned TRACE_SIZE_MAX = 1024;
+    CpuTraceEntryType *trace_;
+    unsigned trace_mask_;
+    uint64_t trace_cnt_;
 };
 
 DECLARE_CLASS(CpuRiscV_Functional)
@@ -223,6 +223,26 @@ public:
     }
 };
 
+/**
+ * @brief WFI (Wait For Interrupt)
+ *
+ * Implemented as a stall: instruction jumps to itself while there's no
+ * pending interrupt, so that the CPU model detects it as an idle self-loop
+ * and fast-forwards step counter to the next scheduled event.
+ */
+class WFI : public IsaProcessor {
+public:
+    WFI() : IsaProcessor("WFI", "00010000001000000000000001110011") {}
+
+    virtual void exec(uint32_t *payload, CpuContextType *data) {
+        if (data->csr[CSR_mip]) {
+            data->npc = data->pc + 4;
+        } else {
+            data->npc = data->pc;
+        }
+    }
+};
+
 /** 
  * @brief FENCE (memory barrier)
  *
@@ -260,6 +280,7 @@ void addIsaPrivilegedRV64I(CpuContextType *data, AttributeType *out) {
     addSupportedInstruction(new CSRRW, out);
     addSupportedInstruction(new CSRRWI, out);
     addSupportedInstruction(new ERET, out);
+    addSupportedInstruction(new WFI, out);
     addSupportedInstruction(new FENCE, out);
     addSupportedInstruction(new FENCE_I, out);
     // TODO:
@@ -22,7 +22,9 @@ static const char *REG_NAMES_LAYOUT[] = {
     "t6", "s11", "npc"
 };
 
-static const uint64_t BASE_ADDR_DSU_REGS = 0x80090200;
+/** CPU context block: x0..x31, pc, npc and others. */
+static const uint64_t BASE_ADDR_DSU_CONTEXT = 0x80090400;
+static const unsigned DSU_CONTEXT_REGS = 34;
 
 
 RegsViewWidget::RegsViewWidget(IGui *igui, QWidget *parent) 
@@ -51,8 +53,13 @@ RegsViewWidget::RegsViewWidget(IGui *igui, QWidget *parent)
 
 
 void RegsViewWidget::handleResponse(AttributeType *req, AttributeType *resp) {
-    uint64_t reg_idx = ((*req)[1].to_uint64() - BASE_ADDR_DSU_REGS) / 8;
-    emit signalRegisterValue(reg_idx, resp->to_uint64());
+    if (!resp->is_data() || resp->size() < 8 * DSU_CONTEXT_REGS) {
+        return;
+    }
+    const uint64_t *ctx = reinterpret_cast<const uint64_t *>(resp->data());
+    for (unsigned i = 0; i < DSU_CONTEXT_REGS; i++) {
+        emit signalRegisterValue(i, ctx[i]);
+    }
 }
 
 void RegsViewWidget::slotConfigure(AttributeType *cfg) {
@@ -78,16 +85,20 @@ void RegsViewWidget::slotPollingUpdate() {
 
 void RegsViewWidget::slotTargetStateChanged(bool running) {
     /** DSU control region 0x80080000 + 0x10000: 
-     *              offset 0x0200 = CPU registers
+     *              offset 0x0400 = CPU context block
      */
-    AttributeType cmdRdReg;
-    cmdRdReg.from_config("['read',0x80090200,8]");
-    for (unsigned i = 0; i < 32; i++) {
-        cmdRdReg[1].make_uint64(BASE_ADDR_DSU_REGS + 0x8 * i);
-        igui_->registerCommand(static_cast<IGuiCmdHandler *>(this), 
-                               &cmdRdReg);
-    }
+    AttributeType cmdRdCtx;
+    cmdRdCtx.from_config("['read',0x80090400,0x180]");
+    igui_->registerCommand(static_cast<IGuiCmdHandler *>(this), &cmdRdCtx);
+}
 
+void RegsViewWidget::slotStepInto() {
+    /** DSU control region 0x80080000 + 0x10000: 
+     *              offset 0x0310 = Step N and read context
+     */
+    AttributeType cmdStep;
+    cmdStep.from_config("['step',1]");
+    igui_->registerCommand(static_cast<IGuiCmdHandler *>(this), &cmdStep);
 }
 
 int RegsViewWidget::widgetIndexByName(const char *regname) {
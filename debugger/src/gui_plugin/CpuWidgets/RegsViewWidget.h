@@ -35,6 +35,7 @@ private slots:
     void slotConfigure(AttributeType *cfg);
     void slotPollingUpdate();
     void slotTargetStateChanged(bool);
+    void slotStepInto();
 
 private:
     int widgetIndexByName(const char *regname);
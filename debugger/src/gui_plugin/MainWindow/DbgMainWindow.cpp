@@ -275,6 +275,8 @@ void DbgMainWindow::addWidgets() {
             actionRegs_, SLOT(setChecked(bool)));
     connect(this, SIGNAL(signalTargetStateChanged(bool)),
             pnew_unclose, SLOT(slotTargetStateChanged(bool)));
+    connect(this, SIGNAL(signalStepInto()),
+            pnew_unclose, SLOT(slotStepInto()));
     actionRegs_->setChecked(false);
     subw->setVisible(actionRegs_->isChecked());
 
@@ -359,21 +361,11 @@ void DbgMainWindow::slotActionTargetHalt() {
 }
 
 void DbgMainWindow::slotActionTargetStepInto() {
-    /** DSU control region 0x80080000 + 0x10000: 
-     *              offset 0x0008 = StepNumber register
-     *              offset 0x0000 = Control register
-     *  Bits[1:0]
-     *      00 = Go
-     *      01 = Halt
-     *      02 = Stepping enable
+    /**
+     * Registers view steps the CPU and gets the new context with one
+     * DSU request.
      */
-    AttributeType cmdStep, cmdStepValue;
-    cmdStepValue.from_config("['write',0x80090008,8,1]");
-    igui_->registerCommand(static_cast<IGuiCmdHandler *>(this), 
-                           &cmdStepValue);
-    cmdStep.from_config("['write',0x80090000,4,2]");
-    igui_->registerCommand(static_cast<IGuiCmdHandler *>(this), 
-                           &cmdStep);
+    emit signalStepInto();
 }
 
 }  // namespace debugger
@@ -44,6 +44,7 @@ signals:
     void signalRedrawByTimer();
     void signalClosingMainForm();
     void signalTargetStateChanged(bool);
+    void signalStepInto();
 
 private slots:
     void slotTimerRedraw();
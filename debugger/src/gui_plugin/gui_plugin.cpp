@@ -10,6 +10,7 @@
 #include "coreservices/iserial.h"
 #include "coreservices/irawlistener.h"
 #include <string>
+#include <string.h>
 #include <QtWidgets/QApplication>
 //#include <QtCore/QtPlugin>
 
@@ -58,6 +59,8 @@ void GuiPlugin::UiThreadType::busyLoop() {
 GuiPlugin::GuiPlugin(const char *name) : IService(name) {
     /// Interface registration
     registerInterface(static_cast<IGui *>(this));
+    registerInterface(static_cast<ITapListener *>(this));
+    registerThreadAttributes(this);
     registerAttribute("GuiConfig", &guiConfig_);
     registerAttribute("Tap", &tap_);
     
@@ -74,6 +77,7 @@ GuiPlugin::GuiPlugin(const char *name) : IService(name) {
     ui_ = NULL;
     RISCV_event_create(&eventUiInitDone_, "eventUiInitDone_");
     RISCV_event_create(&eventCommandAvailable_, "eventCommandAvailable_");
+    RISCV_event_create(&eventTapDone_, "eventTapDone_");
     RISCV_mutex_init(&mutexCommand_);
 
     cmdQueueWrPos_ = 0;
@@ -90,10 +94,6 @@ GuiPlugin::GuiPlugin(const char *name) : IService(name) {
     paths.append(QString(qt_lib_path.c_str()));
     paths.append(QString("platforms"));
     QApplication::setLibraryPaths(paths);
-
-    ui_ = new UiThreadType(static_cast<IGui *>(this), 
-                            &eventUiInitDone_);
-    ui_->run();
 }
 
 GuiPlugin::~GuiPlugin() {
@@ -102,11 +102,19 @@ GuiPlugin::~GuiPlugin() {
     }
     RISCV_event_close(&eventUiInitDone_);
     RISCV_event_close(&eventCommandAvailable_);
+    RISCV_event_close(&eventTapDone_);
     RISCV_mutex_destroy(&mutexCommand_);
 }
 
 void GuiPlugin::initService(const AttributeType *args) {
     IService::initService(args);
+
+    // UI thread is started when the scheduling attributes are known
+    std::string ui_name = std::string(threadName_.to_string()) + "_ui";
+    ui_ = new UiThreadType(static_cast<IGui *>(this), 
+                            &eventUiInitDone_);
+    ui_->setThreadAttributes(affinity_, priority_, ui_name.c_str());
+    ui_->run();
     RISCV_event_wait(&eventUiInitDone_);
 }
 
@@ -161,7 +169,10 @@ void GuiPlugin::registerCommand(IGuiCmdHandler *src, AttributeType *cmd) {
 
 void GuiPlugin::busyLoop() {
     while (loopEnable_) {
-        RISCV_event_wait(&eventCommandAvailable_);
+        // Timeout allows to exit when stop() was called
+        if (RISCV_event_wait_ms(&eventCommandAvailable_, 100)) {
+            continue;
+        }
         RISCV_event_clear(&eventCommandAvailable_);
 
         /** Exit event detected */
@@ -196,7 +207,13 @@ bool GuiPlugin::processCmdQueue() {
         /** Memory read access: */
         if (strcmp(cmd[0u].to_string(), "read") == 0) {
             int bytes = static_cast<int>(cmd[2].to_uint64());
-            uint8_t obuf[32] = {0};
+            uint8_t tbuf[32] = {0};
+            uint8_t *obuf = tbuf;
+            if (bytes > static_cast<int>(sizeof(tbuf))) {
+                // Burst read: CPU context block, memory window
+                obuf = new uint8_t[bytes];
+                memset(obuf, 0, bytes);
+            }
             itap_->read(cmd[1].to_uint64(), bytes, obuf);
             AttributeType resp;
             if (bytes == 1) {
@@ -214,6 +231,19 @@ bool GuiPlugin::processCmdQueue() {
                 cmdQueue_[cmdQueueRdPos_].src->handleResponse(
                             const_cast<AttributeType *>(&cmd), &resp);
             }
+            if (obuf != tbuf) {
+                delete [] obuf;
+            }
+        }
+
+        /** Step N instructions and read CPU context: */
+        if (strcmp(cmd[0u].to_string(), "step") == 0) {
+            AttributeType resp;
+            stepContext(cmd[1].to_uint64(), &resp);
+            if (cmdQueue_[cmdQueueRdPos_].src) {
+                cmdQueue_[cmdQueueRdPos_].src->handleResponse(
+                            const_cast<AttributeType *>(&cmd), &resp);
+            }
         }
 
         /** Memory write access: */
@@ -236,6 +266,32 @@ bool GuiPlugin::processCmdQueue() {
     return false;
 }
 
+/**
+ * One submitted list: bus tap reads the context when the CPU is halted
+ * again, so each step costs one round trip.
+ */
+void GuiPlugin::stepContext(uint64_t steps, AttributeType *resp) {
+    uint8_t ctx[DSU_CONTEXT_BYTES] = {0};
+    TapRequestType reqs[2];
+    reqs[0].addr = DSU_STEP_CTX_ADDR;
+    reqs[0].bytes = 8;
+    reqs[0].buf = reinterpret_cast<uint8_t *>(&steps);
+    reqs[0].rw = 1;
+    reqs[1].addr = DSU_CONTEXT_ADDR;
+    reqs[1].bytes = DSU_CONTEXT_BYTES;
+    reqs[1].buf = ctx;
+    reqs[1].rw = 0;
+
+    RISCV_event_clear(&eventTapDone_);
+    itap_->submit(reqs, 2, static_cast<ITapListener *>(this));
+    RISCV_event_wait(&eventTapDone_);
+    resp->make_data(DSU_CONTEXT_BYTES, ctx);
+}
+
+void GuiPlugin::tapCompleted(TapRequestType *reqs, int cnt) {
+    RISCV_event_set(&eventTapDone_);
+}
+
 void GuiPlugin::stop() {
     qApp->exit();
     IThread::stop();
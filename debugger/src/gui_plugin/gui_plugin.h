@@ -19,7 +19,8 @@ namespace debugger {
 
 class GuiPlugin : public IService,
                   public IThread,
-                  public IGui {
+                  public IGui,
+                  public ITapListener {
 public:
     GuiPlugin(const char *name);
     ~GuiPlugin();
@@ -35,6 +36,9 @@ public:
     virtual void unregisterWidgetInterface(IFace *iface);
     virtual void registerCommand(IGuiCmdHandler *src, AttributeType *cmd);
 
+    /** ITapListener */
+    virtual void tapCompleted(TapRequestType *reqs, int cnt);
+
 protected:
     /** IThread interface */
     virtual void busyLoop();
@@ -43,6 +47,7 @@ protected:
 
 private:
     bool processCmdQueue();
+    void stepContext(uint64_t steps, AttributeType *resp);
 
 private:
     /**
@@ -56,6 +61,14 @@ private:
             igui_ = igui;
             eventInitDone_ = init_done;
         }
+        /** Scheduling attributes are taken from the plugin thread. */
+        void setThreadAttributes(const AttributeType &affinity,
+                                 const AttributeType &priority,
+                                 const char *name) {
+            affinity_ = affinity;
+            priority_ = priority;
+            threadName_.make_string(name);
+        }
     protected:
         /** IThread interface */
         virtual void busyLoop();
@@ -65,6 +78,10 @@ private:
     } *ui_;
 
     static const int CMD_QUEUE_SIZE = 128;
+    /** DSU step N register and CPU context block (simulation only). */
+    static const uint64_t DSU_STEP_CTX_ADDR = 0x80090310;
+    static const uint64_t DSU_CONTEXT_ADDR = 0x80090400;
+    static const int DSU_CONTEXT_BYTES = 0x180;
 
     AttributeType guiConfig_;
     AttributeType tap_;
@@ -72,6 +89,7 @@ private:
 
     event_def eventUiInitDone_;
     event_def eventCommandAvailable_;
+    event_def eventTapDone_;
     mutex_def mutexCommand_;
     DbgMainWindow *mainWindow_;
     struct CmdQueueItemType {
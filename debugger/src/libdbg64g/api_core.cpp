@@ -6,6 +6,10 @@
  */
 
 #include <string>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <atomic>
 #include "api_core.h"
 #include "api_types.h"
 #include "iclass.h"
@@ -19,16 +23,37 @@ static AttributeType Config_;
 static AttributeType listClasses_(Attr_List);
 static AttributeType listHap_(Attr_List);
 static AttributeType listPlugins_(Attr_List);
+/** Cached list of plugins: [[file, size, mtime, [classes]], ...] */
+static AttributeType listManifest_(Attr_List);
 extern mutex_def mutex_printf;
 
-
-extern void _load_plugins(AttributeType *list);
+/**
+ * Registry of the interned names and cached lookup results. Names are
+ * interned only when a service is registered, look-ups never add them.
+ * Services are never destroyed until RISCV_cleanup() so the cached pointers
+ * stay valid while the registry version doesn't change.
+ */
+static mutex_def mutex_registry_;
+static std::unordered_map<std::string, int> mapNames_;
+static std::vector<IService *> listServiceById_;
+static std::unordered_map<std::string, AttributeType> mapIfaceCache_;
+static std::atomic<int> registryVersion_(0);
+
+
+extern void _find_plugins(AttributeType *list);
+extern bool _load_plugin(const char *file, AttributeType *list);
+extern void _start_log_writer();
+extern void _stop_log_writer();
+extern void _init_executor();
+extern void _stop_executor();
 extern void _unload_plugins(AttributeType *list);
 
 class CoreService : public IService {
 public:
     CoreService(const char *name) : IService("CoreService") {
         RISCV_mutex_init(&mutex_printf);
+        RISCV_mutex_init(&mutex_registry_);
+        _init_executor();
         //logLevel_.make_int64(LOG_DEBUG);  // default = LOG_ERROR
     }
 };
@@ -39,6 +64,119 @@ IFace *getInterface(const char *name) {
     return core_.getInterface(name);
 }
 
+/** Plugins manifest file stored near the libraries. */
+static const char *const PLUGINS_MANIFEST_FILE = "plugins/plugins.json";
+
+static std::string _manifest_file_name() {
+    char path[1024];
+    RISCV_get_core_folder(path, sizeof(path));
+    return std::string(path) + std::string(PLUGINS_MANIFEST_FILE);
+}
+
+static void _read_manifest(AttributeType *cache) {
+    static const int MANIFEST_SIZE_MAX = 1 << 16;
+    char *buf = static_cast<char *>(RISCV_malloc(MANIFEST_SIZE_MAX + 1));
+    int sz = RISCV_read_json_file(_manifest_file_name().c_str(), buf,
+                                  MANIFEST_SIZE_MAX);
+    cache->make_list(0);
+    if (sz > 0) {
+        buf[sz] = '\0';
+        cache->from_config(buf);
+    }
+    RISCV_free(buf);
+}
+
+/**
+ * @brief Update list of classes provided by each plugin.
+ * @details Only the libraries modified since the last launch are opened here
+ *          (classes list is taken as a difference of the registered classes
+ *          before and after plugin_init() call). Others are opened on demand
+ *          by RISCV_get_class().
+ */
+static void _update_manifest() {
+    AttributeType files, cache;
+    IClass *icls;
+    bool changed = false;
+
+    _find_plugins(&files);
+    _read_manifest(&cache);
+    if (!cache.is_list() || cache.size() != files.size()) {
+        changed = true;
+    }
+
+    listManifest_.make_list(0);
+    for (unsigned i = 0; i < files.size(); i++) {
+        const AttributeType &file = files[i];
+        AttributeType item;
+        bool cached = false;
+        for (unsigned n = 0; cache.is_list() && n < cache.size(); n++) {
+            const AttributeType &t = cache[n];
+            if (t.is_list() && t.size() == 4
+                && strcmp(t[0u].to_string(), file[0u].to_string()) == 0
+                && t[1].to_uint64() == file[1].to_uint64()
+                && t[2].to_uint64() == file[2].to_uint64()) {
+                item = t;
+                cached = true;
+                break;
+            }
+        }
+
+        if (!cached) {
+            unsigned cls_cnt = listClasses_.size();
+            item.make_list(4);
+            item[0u] = file[0u];
+            item[1] = file[1];
+            item[2] = file[2];
+            item[3].make_list(0);
+            _load_plugin(file[0u].to_string(), &listPlugins_);
+            for (unsigned n = cls_cnt; n < listClasses_.size(); n++) {
+                icls = static_cast<IClass *>(listClasses_[n].to_iface());
+                AttributeType t1(icls->getClassName());
+                item[3].add_to_list(&t1);
+            }
+            changed = true;
+        }
+        listManifest_.add_to_list(&item);
+    }
+
+    if (changed) {
+        RISCV_write_json_file(_manifest_file_name().c_str(),
+                              listManifest_.to_config());
+    }
+}
+
+static bool _is_plugin_loaded(const char *file) {
+    size_t len = strlen(file);
+    for (unsigned i = 0; i < listPlugins_.size(); i++) {
+        const char *path = listPlugins_[i][0u].to_string();
+        size_t path_len = strlen(path);
+        if (path_len >= len && strcmp(&path[path_len - len], file) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Open plugin that provides specified class.
+ * @return true if the new library was loaded.
+ */
+static bool _load_plugin_of_class(const char *name) {
+    for (unsigned i = 0; i < listManifest_.size(); i++) {
+        const AttributeType &item = listManifest_[i];
+        const AttributeType &classes = item[3];
+        for (unsigned n = 0; n < classes.size(); n++) {
+            if (strcmp(name, classes[n].to_string()) != 0) {
+                continue;
+            }
+            if (_is_plugin_loaded(item[0u].to_string())) {
+                return false;
+            }
+            return _load_plugin(item[0u].to_string(), &listPlugins_);
+        }
+    }
+    return false;
+}
 
 extern "C" int RISCV_init() {
 #if defined(_WIN32) || defined(__CYGWIN__)
@@ -48,7 +186,8 @@ extern "C" int RISCV_init() {
     }
 #endif
 
-    _load_plugins(&listPlugins_);
+    _start_log_writer();
+    _update_manifest();
     return 0;
 }
 
@@ -66,16 +205,230 @@ extern "C" void RISCV_cleanup() {
             icls->predeleteServices(iserv);
         }
     }
+    _stop_executor();
+    _stop_log_writer();
 
 #if defined(_WIN32) || defined(__CYGWIN__)
     WSACleanup();
 #endif
 
     _unload_plugins(&listPlugins_);
+    RISCV_mutex_lock(&mutex_registry_);
+    listServiceById_.clear();
+    mapIfaceCache_.clear();
+    RISCV_mutex_unlock(&mutex_registry_);
+    RISCV_mutex_destroy(&mutex_registry_);
     RISCV_mutex_lock(&mutex_printf);
     RISCV_mutex_destroy(&mutex_printf);
 }
 
+/**
+ * @brief Store new service into the name registry.
+ * @details Any previously cached list of interfaces becomes invalid because
+ *          the new service may implement them.
+ */
+static void _register_service(IService *iserv) {
+    int id = RISCV_intern_name(iserv->getObjName());
+    RISCV_mutex_lock(&mutex_registry_);
+    if (static_cast<unsigned>(id) >= listServiceById_.size()) {
+        listServiceById_.resize(id + 1, NULL);
+    }
+    listServiceById_[id] = iserv;
+    mapIfaceCache_.clear();
+    registryVersion_++;
+    RISCV_mutex_unlock(&mutex_registry_);
+}
+
+/** Default number of threads used for the services post-initialization. */
+static const int POSTINIT_THREADS_DEFAULT = 4;
+
+/**
+ * @brief Group of services post-initialized serially by one worker.
+ * @details Services that reference the same service are placed into one
+ *          group because they usually register listeners/callbacks in it.
+ */
+struct PostinitQueueType {
+    mutex_def mutex;
+    semaphore_def done;
+    std::vector<std::vector<IService *> > groups;
+    unsigned next;
+};
+
+static void _postinit_worker(void *arg) {
+    PostinitQueueType *q = reinterpret_cast<PostinitQueueType *>(arg);
+    unsigned idx;
+    while (1) {
+        RISCV_mutex_lock(&q->mutex);
+        idx = q->next++;
+        RISCV_mutex_unlock(&q->mutex);
+        if (idx >= q->groups.size()) {
+            break;
+        }
+        for (unsigned i = 0; i < q->groups[idx].size(); i++) {
+            q->groups[idx][i]->postinitService();
+        }
+    }
+}
+
+static void _postinit_task(void *arg) {
+    PostinitQueueType *q = reinterpret_cast<PostinitQueueType *>(arg);
+    _postinit_worker(q);
+    RISCV_semaphore_post(&q->done);
+}
+
+/**
+ * @brief Process groups by the current thread and (threads - 1) tasks
+ *        submitted into the core thread pool.
+ */
+static void _postinit_groups(PostinitQueueType *q, int threads) {
+    q->next = 0;
+    if (static_cast<unsigned>(threads) > q->groups.size()) {
+        threads = static_cast<int>(q->groups.size());
+    }
+    for (int i = 1; i < threads; i++) {
+        RISCV_submit(_postinit_task, q);
+    }
+    _postinit_worker(q);
+    for (int i = 1; i < threads; i++) {
+        RISCV_semaphore_wait(&q->done);
+    }
+}
+
+/**
+ * @brief Find services referenced by the attributes of the given service.
+ * @details String attribute (or string item of the list attribute) equal to
+ *          the name of the existing service is considered as a dependency:
+ *          'Bus', 'Tap', 'Transport', 'HostIO', 'MapList' and etc.
+ */
+static void _get_dependencies(IService *iserv,
+                              std::map<std::string, unsigned> &idx,
+                              std::vector<unsigned> *deps) {
+    AttributeType cfg = iserv->getConfiguration();
+    AttributeType &attrs = cfg["Attr"];
+    std::map<std::string, unsigned>::iterator it;
+    for (unsigned i = 0; i < attrs.size(); i++) {
+        const AttributeType &val = attrs[i][1];
+        if (val.is_string()) {
+            if ((it = idx.find(val.to_string())) != idx.end()) {
+                deps->push_back(it->second);
+            }
+        } else if (val.is_list()) {
+            for (unsigned n = 0; n < val.size(); n++) {
+                if (!val[n].is_string()) {
+                    continue;
+                }
+                if ((it = idx.find(val[n].to_string())) != idx.end()) {
+                    deps->push_back(it->second);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Call postinitService() of all services in dependency order.
+ * @details Services are splitted on levels so that each service is
+ *          post-initialized after all services it references. Services of
+ *          the same level are independent and run on the core thread pool. Cyclic
+ *          dependencies are resolved in the order of classes registration
+ *          as it was done before.
+ */
+static void _postinit_services(int threads) {
+    IClass *icls;
+    const AttributeType *objs;
+    std::vector<IService *> srv;
+    std::map<std::string, unsigned> idx;
+
+    for (unsigned i = 0; i < listClasses_.size(); i++) {
+        icls = static_cast<IClass *>(listClasses_[i].to_iface());
+        objs = icls->getInstanceList();
+        for (unsigned n = 0; n < objs->size(); n++) {
+            IService *iserv = static_cast<IService *>((*objs)[n].to_iface());
+            idx[iserv->getObjName()] = static_cast<unsigned>(srv.size());
+            srv.push_back(iserv);
+        }
+    }
+
+    unsigned total = static_cast<unsigned>(srv.size());
+    std::vector<std::vector<unsigned> > deps(total);
+    std::vector<bool> done(total, false);
+    for (unsigned i = 0; i < total; i++) {
+        _get_dependencies(srv[i], idx, &deps[i]);
+    }
+
+    PostinitQueueType q;
+    RISCV_mutex_init(&q.mutex);
+    RISCV_semaphore_create(&q.done, 0);
+    unsigned done_cnt = 0;
+    while (done_cnt < total) {
+        std::vector<unsigned> level;
+        for (unsigned i = 0; i < total; i++) {
+            if (done[i]) {
+                continue;
+            }
+            bool ready = true;
+            for (unsigned n = 0; n < deps[i].size(); n++) {
+                if (deps[i][n] != i && !done[deps[i][n]]) {
+                    ready = false;
+                    break;
+                }
+            }
+            if (ready) {
+                level.push_back(i);
+            }
+        }
+        if (level.size() == 0) {
+            // Cycle: take the first one in the registration order
+            for (unsigned i = 0; i < total; i++) {
+                if (!done[i]) {
+                    level.push_back(i);
+                    break;
+                }
+            }
+        }
+
+        // Merge services with the common dependency into one group:
+        std::vector<int> group(total, -1);
+        q.groups.clear();
+        for (unsigned i = 0; i < level.size(); i++) {
+            unsigned k = level[i];
+            int g = -1;
+            for (unsigned n = 0; n < deps[k].size() && g < 0; n++) {
+                g = group[deps[k][n]];
+            }
+            if (g < 0) {
+                g = static_cast<int>(q.groups.size());
+                q.groups.push_back(std::vector<IService *>());
+            }
+            q.groups[g].push_back(srv[k]);
+            for (unsigned n = 0; n < deps[k].size(); n++) {
+                int prev = group[deps[k][n]];
+                if (prev >= 0 && prev != g) {
+                    // Join two groups referencing the same service
+                    q.groups[g].insert(q.groups[g].end(),
+                            q.groups[prev].begin(), q.groups[prev].end());
+                    q.groups[prev].clear();
+                    for (unsigned m = 0; m < total; m++) {
+                        if (group[m] == prev) {
+                            group[m] = g;
+                        }
+                    }
+                }
+                group[deps[k][n]] = g;
+            }
+        }
+
+        _postinit_groups(&q, threads);
+
+        for (unsigned i = 0; i < level.size(); i++) {
+            done[level[i]] = true;
+        }
+        done_cnt += static_cast<unsigned>(level.size());
+    }
+    RISCV_semaphore_close(&q.done);
+    RISCV_mutex_destroy(&q.mutex);
+}
+
 extern "C" void RISCV_set_configuration(AttributeType *cfg) {
     IClass *icls;
     IService *iserv;
@@ -89,6 +442,16 @@ extern "C" void RISCV_set_configuration(AttributeType *cfg) {
     AttributeType &Services = Config_["Services"];
     if (Services.is_list()) {
         for (unsigned i = 0; i < Services.size(); i++) {
+            /** Special global setting for the GUI class: */
+            if (strcmp(Services[i]["Class"].to_string(),
+                       "GuiPluginClass") == 0) {
+                if (!Config_["GlobalSettings"]["GUI"].to_bool()) {
+                    RISCV_info("%s", "GUI disabled");
+                    continue;
+                }
+            }
+
+            // Plugin library is opened here if it wasn't loaded yet
             icls = static_cast<IClass *>(
                 RISCV_get_class(Services[i]["Class"].to_string()));
             if (icls == NULL) {
@@ -96,27 +459,23 @@ extern "C" void RISCV_set_configuration(AttributeType *cfg) {
                              Services[i]["Class"].to_string());
                 continue;
             }
-            /** Special global setting for the GUI class: */
-            if (strcmp(icls->getClassName(), "GuiPluginClass") == 0) {
-                if (!Config_["GlobalSettings"]["GUI"].to_bool()) {
-                    RISCV_info("%s", "GUI disabled");
-                    continue;
-                }
-            }
 
             AttributeType &Instances = Services[i]["Instances"];
             for (unsigned n = 0; n < Instances.size(); n++) {
                 iserv = icls->createService(Instances[n]["Name"].to_string());
+                _register_service(iserv);
                 iserv->initService(&Instances[n]["Attr"]);
             }
         }
     }
 
     // Post initialization
-    for (unsigned i = 0; i < listClasses_.size(); i++) {
-        icls = static_cast<IClass *>(listClasses_[i].to_iface());
-        icls->postinitServices();
+    int threads = POSTINIT_THREADS_DEFAULT;
+    if (Config_["GlobalSettings"]["InitThreads"].is_integer()) {
+        threads = static_cast<int>(
+            Config_["GlobalSettings"]["InitThreads"].to_int64());
     }
+    _postinit_services(threads);
 
     RISCV_printf(getInterface(IFACE_SERVICE), 0, "%s",
     "\n**********************************************************\n"
@@ -145,6 +504,23 @@ extern "C" const char *RISCV_get_configuration() {
         AttributeType val = icls->getConfiguration();
         ret["Services"].add_to_list(&val);
     }
+
+    // Keep configuration of the classes which plugins weren't opened:
+    AttributeType &Services = Config_["Services"];
+    for (unsigned i = 0; Services.is_list() && i < Services.size(); i++) {
+        const char *clsname = Services[i]["Class"].to_string();
+        bool loaded = false;
+        for (unsigned n = 0; n < listClasses_.size(); n++) {
+            icls = static_cast<IClass *>(listClasses_[n].to_iface());
+            if (strcmp(clsname, icls->getClassName()) == 0) {
+                loaded = true;
+                break;
+            }
+        }
+        if (!loaded) {
+            ret["Services"].add_to_list(&Services[i]);
+        }
+    }
     return ret.to_config();
 }
 
@@ -183,6 +559,9 @@ extern "C" IFace *RISCV_get_class(const char *name) {
             return icls;
         }
     }
+    if (_load_plugin_of_class(name)) {
+        return RISCV_get_class(name);
+    }
     return NULL;
 }
 
@@ -190,17 +569,47 @@ extern "C" IFace *RISCV_create_service(IFace *iclass, const char *name,
                                         AttributeType *args) {
     IClass *icls = static_cast<IClass *>(iclass);
     IService *iobj = icls->createService(name);
+    _register_service(iobj);
     iobj->initService(args);
     iobj->postinitService();
     return iobj;
 }
 
+extern "C" int RISCV_intern_name(const char *name) {
+    int ret;
+    RISCV_mutex_lock(&mutex_registry_);
+    std::pair<std::unordered_map<std::string, int>::iterator, bool> res =
+        mapNames_.insert(std::make_pair(std::string(name),
+                         static_cast<int>(mapNames_.size())));
+    ret = res.first->second;
+    RISCV_mutex_unlock(&mutex_registry_);
+    return ret;
+}
+
+extern "C" int RISCV_get_registry_version() {
+    return registryVersion_.load();
+}
+
 extern "C" IFace *RISCV_get_service(const char *name) {
     IClass *icls;
-    IService *iserv;
+    IService *iserv = NULL;
+
+    RISCV_mutex_lock(&mutex_registry_);
+    std::unordered_map<std::string, int>::iterator it = mapNames_.find(name);
+    if (it != mapNames_.end()
+        && static_cast<unsigned>(it->second) < listServiceById_.size()) {
+        iserv = listServiceById_[it->second];
+    }
+    RISCV_mutex_unlock(&mutex_registry_);
+    if (iserv) {
+        return iserv;
+    }
+
+    // Service created without registry (directly via IClass interface)
     for (unsigned i = 0; i < listClasses_.size(); i++) {
         icls = static_cast<IClass *>(listClasses_[i].to_iface());
         if ((iserv = icls->getInstance(name)) != NULL) {
+            _register_service(iserv);
             return iserv;
         }
     }
@@ -223,8 +632,18 @@ extern "C" void RISCV_get_services_with_iface(const char *iname,
     IService *iserv;
     IFace *iface;
     const AttributeType *tlist;
+
+    RISCV_mutex_lock(&mutex_registry_);
+    std::unordered_map<std::string, AttributeType>::iterator it =
+        mapIfaceCache_.find(iname);
+    if (it != mapIfaceCache_.end()) {
+        *list = it->second;
+        RISCV_mutex_unlock(&mutex_registry_);
+        return;
+    }
+    RISCV_mutex_unlock(&mutex_registry_);
+
     list->make_list(0);
-    
     for (unsigned i = 0; i < listClasses_.size(); i++) {
         icls = static_cast<IClass *>(listClasses_[i].to_iface());
         tlist = icls->getInstanceList();
@@ -237,6 +656,10 @@ extern "C" void RISCV_get_services_with_iface(const char *iname,
             }
         }
     }
+
+    RISCV_mutex_lock(&mutex_registry_);
+    mapIfaceCache_[iname] = *list;
+    RISCV_mutex_unlock(&mutex_registry_);
 }
 
 extern "C" void RISCV_get_clock_services(AttributeType *list) {
@@ -0,0 +1,290 @@
+/**
+ * @file
+ * @copyright  Copyright 2016 GNSS Sensor Ltd. All right reserved.
+ * @author     Sergey Khabarov - sergeykhbr@gmail.com
+ * @brief      Core thread pool (executor) and timers implementation.
+ */
+
+#include <deque>
+#include <map>
+#include <atomic>
+#include "api_core.h"
+#include "api_types.h"
+#include "iservice.h"
+
+namespace debugger {
+
+/** Core log message interface object. */
+extern IFace *getInterface(const char *name);
+
+/** Maximum number of the pool threads. */
+static const int EXECUTOR_THREADS_MAX = 32;
+/** Default number of the pool threads if not defined in GlobalSettings. */
+static const int EXECUTOR_THREADS_DEFAULT = 4;
+/** Queued tasks are completed on stop, unless they hang longer than this. */
+static const int EXECUTOR_DRAIN_MS = 10000;
+
+struct TaskType {
+    lib_task_func func;
+    void *args;
+};
+
+/** Task queue of one pool thread. */
+struct WorkerType {
+    LibThreadType thread;
+    mutex_def mutex;
+    std::deque<TaskType> tasks;
+};
+
+/** Delayed task. */
+struct TimerType {
+    uint64_t id;
+    TaskType task;
+};
+
+static WorkerType workers_[EXECUTOR_THREADS_MAX];
+static int workers_total_ = 0;
+static volatile bool executor_ena_ = false;
+/** Number of the tasks in all queues. */
+static semaphore_def sem_tasks_;
+/** Submitted but not completed tasks, zero sets drain_event_. */
+static std::atomic<int> tasks_pending_(0);
+static event_def drain_event_;
+static mutex_def mutex_executor_;
+static unsigned submit_idx_ = 0;
+static THREAD_LOCAL int worker_idx_ = -1;
+
+static LibThreadType timer_thread_;
+static event_def timer_event_;
+static mutex_def mutex_timers_;
+static std::multimap<uint64_t, TimerType> timers_;
+static uint64_t timer_id_ = 0;
+
+/**
+ * @brief Get task from own queue (LIFO) or steal from another one (FIFO).
+ */
+static bool _get_task(int idx, TaskType *task) {
+    WorkerType *w = &workers_[idx];
+    RISCV_mutex_lock(&w->mutex);
+    if (!w->tasks.empty()) {
+        *task = w->tasks.back();
+        w->tasks.pop_back();
+        RISCV_mutex_unlock(&w->mutex);
+        return true;
+    }
+    RISCV_mutex_unlock(&w->mutex);
+
+    for (int i = 1; i < workers_total_; i++) {
+        w = &workers_[(idx + i) % workers_total_];
+        RISCV_mutex_lock(&w->mutex);
+        if (!w->tasks.empty()) {
+            *task = w->tasks.front();
+            w->tasks.pop_front();
+            RISCV_mutex_unlock(&w->mutex);
+            return true;
+        }
+        RISCV_mutex_unlock(&w->mutex);
+    }
+    return false;
+}
+
+static thread_return_t _worker_thread(void *arg) {
+    TaskType task;
+    worker_idx_ = static_cast<int>(reinterpret_cast<intptr_t>(arg));
+    while (1) {
+        // Each semaphore count guarantees one task in the queues
+        RISCV_semaphore_wait(&sem_tasks_);
+        while (!_get_task(worker_idx_, &task)) {
+            // Queues are scanned one by one: the task may be pushed into
+            // already scanned queue while other worker takes the one ahead
+            RISCV_sleep_ms(0);
+        }
+        if (task.func == NULL) {
+            // Exit request
+            break;
+        }
+        task.func(task.args);
+        if (--tasks_pending_ == 0) {
+            RISCV_event_set(&drain_event_);
+        }
+    }
+    return 0;
+}
+
+static thread_return_t _timer_thread(void *arg) {
+    uint64_t t;
+    int wait_ms;
+    while (executor_ena_) {
+        wait_ms = 1000;
+        t = RISCV_get_time_ms();
+        RISCV_event_clear(&timer_event_);
+        RISCV_mutex_lock(&mutex_timers_);
+        while (!timers_.empty()) {
+            std::multimap<uint64_t, TimerType>::iterator it = timers_.begin();
+            if (it->first > t) {
+                wait_ms = static_cast<int>(it->first - t);
+                break;
+            }
+            RISCV_submit(it->second.task.func, it->second.task.args);
+            timers_.erase(it);
+        }
+        RISCV_mutex_unlock(&mutex_timers_);
+        RISCV_event_wait_ms(&timer_event_, wait_ms);
+    }
+    return 0;
+}
+
+/**
+ * @brief Start thread pool.
+ * @details Number of threads is taken from the GlobalSettings attribute
+ *          'ExecutorThreads' if it was defined before the first task.
+ */
+static void _start_executor() {
+    int total = EXECUTOR_THREADS_DEFAULT;
+    const AttributeType *glb = RISCV_get_global_settings();
+    if (glb->is_dict() && (*glb)["ExecutorThreads"].is_integer()) {
+        total = static_cast<int>((*glb)["ExecutorThreads"].to_int64());
+    }
+    if (total < 1) {
+        total = 1;
+    } else if (total > EXECUTOR_THREADS_MAX) {
+        total = EXECUTOR_THREADS_MAX;
+    }
+
+    RISCV_semaphore_create(&sem_tasks_, 0);
+    RISCV_event_create(&drain_event_, "executor_drain");
+    RISCV_mutex_init(&mutex_timers_);
+    RISCV_event_create(&timer_event_, "timer_event");
+    for (int i = 0; i < total; i++) {
+        RISCV_mutex_init(&workers_[i].mutex);
+    }
+    workers_total_ = total;
+    executor_ena_ = true;
+    for (int i = 0; i < total; i++) {
+        workers_[i].thread.func = (lib_thread_func)_worker_thread;
+        workers_[i].thread.args = reinterpret_cast<void *>(
+                                    static_cast<intptr_t>(i));
+        workers_[i].thread.Handle = 0;
+        workers_[i].thread.name = "executor";
+        RISCV_thread_create(&workers_[i].thread);
+    }
+    timer_thread_.func = (lib_thread_func)_timer_thread;
+    timer_thread_.args = 0;
+    timer_thread_.Handle = 0;
+    timer_thread_.name = "executor_timer";
+    RISCV_thread_create(&timer_thread_);
+}
+
+void _init_executor() {
+    RISCV_mutex_init(&mutex_executor_);
+}
+
+/**
+ * @brief Stop pool threads.
+ * @details Queued tasks are completed first because their submitters may
+ *          wait for them (TAP transfers). Exit requests are put into the
+ *          head of the queues, only tasks hanging for EXECUTOR_DRAIN_MS
+ *          are dropped.
+ */
+void _stop_executor() {
+    RISCV_mutex_lock(&mutex_executor_);
+    if (!executor_ena_) {
+        RISCV_mutex_unlock(&mutex_executor_);
+        RISCV_mutex_destroy(&mutex_executor_);
+        return;
+    }
+    RISCV_mutex_unlock(&mutex_executor_);
+
+    uint64_t t0 = RISCV_get_time_ms();
+    while ((RISCV_get_time_ms() - t0) < EXECUTOR_DRAIN_MS) {
+        // Cleared before the check so that the last completion isn't missed
+        RISCV_event_clear(&drain_event_);
+        if (tasks_pending_.load() == 0) {
+            break;
+        }
+        RISCV_event_wait_ms(&drain_event_, 100);
+    }
+    if (tasks_pending_.load() > 0) {
+        RISCV_error("%d tasks dropped", tasks_pending_.load());
+    }
+
+    RISCV_mutex_lock(&mutex_executor_);
+    executor_ena_ = false;
+    RISCV_mutex_unlock(&mutex_executor_);
+
+    RISCV_event_set(&timer_event_);
+    RISCV_thread_join(timer_thread_.Handle, 50000);
+
+    for (int i = 0; i < workers_total_; i++) {
+        RISCV_mutex_lock(&workers_[i].mutex);
+        TaskType exit_task = {NULL, NULL};
+        workers_[i].tasks.push_front(exit_task);
+        RISCV_mutex_unlock(&workers_[i].mutex);
+        RISCV_semaphore_post(&sem_tasks_);
+    }
+    for (int i = 0; i < workers_total_; i++) {
+        RISCV_thread_join(workers_[i].thread.Handle, 50000);
+        RISCV_mutex_destroy(&workers_[i].mutex);
+    }
+    timers_.clear();
+    tasks_pending_ = 0;
+    RISCV_event_close(&drain_event_);
+    RISCV_event_close(&timer_event_);
+    RISCV_mutex_destroy(&mutex_timers_);
+    RISCV_semaphore_close(&sem_tasks_);
+    RISCV_mutex_destroy(&mutex_executor_);
+}
+
+extern "C" void RISCV_submit(lib_task_func func, void *args) {
+    TaskType task = {func, args};
+    int idx = worker_idx_;
+    if (idx < 0) {
+        RISCV_mutex_lock(&mutex_executor_);
+        if (!executor_ena_) {
+            _start_executor();
+        }
+        idx = static_cast<int>(submit_idx_++ % workers_total_);
+        RISCV_mutex_unlock(&mutex_executor_);
+    }
+
+    WorkerType *w = &workers_[idx];
+    tasks_pending_++;
+    RISCV_mutex_lock(&w->mutex);
+    w->tasks.push_back(task);
+    RISCV_mutex_unlock(&w->mutex);
+    RISCV_semaphore_post(&sem_tasks_);
+}
+
+extern "C" uint64_t RISCV_schedule_after(int ms, lib_task_func func,
+                                         void *args) {
+    TimerType timer;
+    RISCV_mutex_lock(&mutex_executor_);
+    if (!executor_ena_) {
+        _start_executor();
+    }
+    RISCV_mutex_unlock(&mutex_executor_);
+
+    timer.task.func = func;
+    timer.task.args = args;
+    RISCV_mutex_lock(&mutex_timers_);
+    timer.id = ++timer_id_;
+    timers_.insert(std::pair<uint64_t, TimerType>(
+                    RISCV_get_time_ms() + static_cast<uint64_t>(ms), timer));
+    RISCV_mutex_unlock(&mutex_timers_);
+    RISCV_event_set(&timer_event_);
+    return timer.id;
+}
+
+extern "C" void RISCV_cancel_timer(uint64_t id) {
+    RISCV_mutex_lock(&mutex_timers_);
+    std::multimap<uint64_t, TimerType>::iterator it;
+    for (it = timers_.begin(); it != timers_.end(); ++it) {
+        if (it->second.id == id) {
+            timers_.erase(it);
+            break;
+        }
+    }
+    RISCV_mutex_unlock(&mutex_timers_);
+}
+
+}  // namespace debugger
@@ -7,11 +7,16 @@
 
 #include <string.h>
 #include <time.h>
+#include <errno.h>
 #include <iostream>
+#include <atomic>
 #include <dirent.h>
+#include <sys/stat.h>
 #if defined(_WIN32) || defined(__CYGWIN__)
 #else
     #include <dlfcn.h>
+    #include <sched.h>
+    #include <pthread.h>
 #endif
 #include "api_types.h"
 #include "api_utils.h"
@@ -25,8 +30,38 @@ namespace debugger {
 /** Plugin Entry point type definition */
 typedef void (*plugin_init_proc)();
 
-/** Temporary buffer for the log messages. */
-static char bufLog[1<<12];
+/** Maximum length of the one log message. */
+static const int LOG_MSG_MAX = 1 << 12;
+/** Size of the per-thread log ring buffer. */
+static const uint32_t LOG_RING_SIZE = 1 << 16;
+/** Maximum number of threads with own log ring buffers. */
+static const int LOG_RINGS_MAX = 64;
+/** Writer thread wake-up interval when all buffers are empty. */
+static const int LOG_WRITER_IDLE_MS = 100;
+
+/**
+ * @brief Single producer/single consumer ring of the log messages.
+ * @details Each message is stored as 2-bytes length and text without
+ *          terminating zero. Only the owner thread writes messages, while
+ *          readers are serialized by mutex_printf. Ring of the exited
+ *          thread is marked free and taken by the next new thread, its
+ *          pending messages are still written in order.
+ */
+struct LogRingType {
+    std::atomic<uint32_t> wrcnt;
+    std::atomic<uint32_t> rdcnt;
+    std::atomic<bool> free;
+    char buf[LOG_RING_SIZE];
+};
+
+static THREAD_LOCAL LogRingType *log_ring_ = 0;
+static LogRingType *log_rings_[LOG_RINGS_MAX];
+static std::atomic<int> log_rings_cnt_(0);
+static mutex_def mutex_rings_;
+static LibThreadType log_writer_;
+static volatile bool log_writer_ena_ = false;
+static std::atomic<bool> log_writer_idle_(false);
+static event_def log_event_;
 
 /** Redirect output to specified console. */
 static IConsole *default_console = NULL;
@@ -37,6 +72,194 @@ mutex_def mutex_printf;
 /** Core log message interface object. */
 extern IFace *getInterface(const char *name);
 
+extern "C" void RISCV_print_bin(int level, char *buf, int len);
+
+static void _log_output(int level, char *buf, int len) {
+    if (default_console) {
+        default_console->writeBuffer(buf);
+    } else {
+        RISCV_print_bin(level, buf, len);
+    }
+}
+
+/** Thread exit notification to release the log ring. */
+#if defined(_WIN32) || defined(__CYGWIN__)
+static DWORD log_ring_key_ = FLS_OUT_OF_INDEXES;
+
+static VOID NTAPI _log_release_ring(PVOID arg) {
+    if (arg) {
+        static_cast<LogRingType *>(arg)->free.store(true);
+    }
+}
+#else
+static pthread_key_t log_ring_key_;
+static bool log_ring_key_ena_ = false;
+
+static void _log_release_ring(void *arg) {
+    static_cast<LogRingType *>(arg)->free.store(true);
+}
+#endif
+
+/**
+ * @brief Get ring of the current thread.
+ * @details Free ring is reused before a new one is allocated. When all
+ *          rings are busy the caller writes synchronously and tries again
+ *          with the next message.
+ */
+static LogRingType *_log_get_ring() {
+    if (log_ring_) {
+        return log_ring_;
+    }
+    RISCV_mutex_lock(&mutex_rings_);
+    int cnt = log_rings_cnt_.load();
+    for (int i = 0; i < cnt; i++) {
+        bool expected = true;
+        if (log_rings_[i]->free.compare_exchange_strong(expected, false)) {
+            log_ring_ = log_rings_[i];
+            break;
+        }
+    }
+    if (!log_ring_ && cnt < LOG_RINGS_MAX) {
+        log_ring_ = new LogRingType;
+        log_ring_->wrcnt = 0;
+        log_ring_->rdcnt = 0;
+        log_ring_->free = false;
+        log_rings_[cnt] = log_ring_;
+        log_rings_cnt_.store(cnt + 1);
+    }
+    RISCV_mutex_unlock(&mutex_rings_);
+    if (log_ring_) {
+#if defined(_WIN32) || defined(__CYGWIN__)
+        if (log_ring_key_ != FLS_OUT_OF_INDEXES) {
+            FlsSetValue(log_ring_key_, log_ring_);
+        }
+#else
+        if (log_ring_key_ena_) {
+            pthread_setspecific(log_ring_key_, log_ring_);
+        }
+#endif
+    }
+    return log_ring_;
+}
+
+/**
+ * @brief Put message into the ring buffer of the current thread.
+ * @return false if the message should be written synchronously.
+ */
+static bool _log_push(const char *msg, int len) {
+    if (!log_writer_ena_) {
+        return false;
+    }
+    LogRingType *p = _log_get_ring();
+    if (!p) {
+        return false;
+    }
+    uint32_t wr = p->wrcnt.load(std::memory_order_relaxed);
+    uint32_t rd = p->rdcnt.load(std::memory_order_acquire);
+    uint32_t need = static_cast<uint32_t>(len) + 2;
+    if (LOG_RING_SIZE - (wr - rd) < need) {
+        return false;
+    }
+    p->buf[wr % LOG_RING_SIZE] = static_cast<char>(len);
+    p->buf[(wr + 1) % LOG_RING_SIZE] = static_cast<char>(len >> 8);
+    for (int i = 0; i < len; i++) {
+        p->buf[(wr + 2 + i) % LOG_RING_SIZE] = msg[i];
+    }
+    p->wrcnt.store(wr + need, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (log_writer_idle_.load(std::memory_order_relaxed)) {
+        RISCV_event_set(&log_event_);
+    }
+    return true;
+}
+
+/**
+ * @brief Write all buffered messages into the output stream.
+ * @details Must be called with locked mutex_printf.
+ * @return Number of written messages.
+ */
+static int _log_drain() {
+    char msg[LOG_MSG_MAX + 1];
+    int total = 0;
+    int cnt = log_rings_cnt_.load(std::memory_order_acquire);
+    for (int i = 0; i < cnt; i++) {
+        LogRingType *p = log_rings_[i];
+        uint32_t rd = p->rdcnt.load(std::memory_order_relaxed);
+        uint32_t wr = p->wrcnt.load(std::memory_order_acquire);
+        while (rd != wr) {
+            int len = static_cast<uint8_t>(p->buf[rd % LOG_RING_SIZE]);
+            len |= static_cast<uint8_t>(p->buf[(rd + 1) % LOG_RING_SIZE]) << 8;
+            for (int n = 0; n < len; n++) {
+                msg[n] = p->buf[(rd + 2 + n) % LOG_RING_SIZE];
+            }
+            msg[len] = '\0';
+            rd += static_cast<uint32_t>(len) + 2;
+            p->rdcnt.store(rd, std::memory_order_release);
+            _log_output(LOG_INFO, msg, len);
+            total++;
+        }
+    }
+    return total;
+}
+
+static thread_return_t _log_writer_thread(void *arg) {
+    int cnt;
+    while (log_writer_ena_) {
+        RISCV_mutex_lock(&mutex_printf);
+        cnt = _log_drain();
+        RISCV_mutex_unlock(&mutex_printf);
+        if (cnt != 0) {
+            continue;
+        }
+        // Mark as idle and re-check to avoid lost wake-up
+        RISCV_event_clear(&log_event_);
+        log_writer_idle_.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        RISCV_mutex_lock(&mutex_printf);
+        cnt = _log_drain();
+        RISCV_mutex_unlock(&mutex_printf);
+        if (cnt == 0) {
+            RISCV_event_wait_ms(&log_event_, LOG_WRITER_IDLE_MS);
+        }
+        log_writer_idle_.store(false);
+    }
+    return 0;
+}
+
+/** Start background thread that writes buffered log messages. */
+void _start_log_writer() {
+    RISCV_mutex_init(&mutex_rings_);
+#if defined(_WIN32) || defined(__CYGWIN__)
+    log_ring_key_ = FlsAlloc(_log_release_ring);
+#else
+    log_ring_key_ena_ =
+        pthread_key_create(&log_ring_key_, _log_release_ring) == 0;
+#endif
+    RISCV_event_create(&log_event_, "log_event");
+    log_writer_ena_ = true;
+    log_writer_.func = (lib_thread_func)_log_writer_thread;
+    log_writer_.args = 0;
+    log_writer_.Handle = 0;
+    log_writer_.name = "log_writer";
+    RISCV_thread_create(&log_writer_);
+    if (!log_writer_.Handle) {
+        log_writer_ena_ = false;
+    }
+}
+
+/** Stop writer thread and flush all buffered log messages. */
+void _stop_log_writer() {
+    if (!log_writer_ena_) {
+        return;
+    }
+    log_writer_ena_ = false;
+    RISCV_event_set(&log_event_);
+    RISCV_thread_join(log_writer_.Handle, 50000);
+    RISCV_event_close(&log_event_);
+    RISCV_mutex_lock(&mutex_printf);
+    _log_drain();
+    RISCV_mutex_unlock(&mutex_printf);
+}
 
 extern "C" void RISCV_set_default_output(void *iout) {
     default_console = static_cast<IConsole *>(iout);
@@ -53,44 +276,59 @@ extern "C" int RISCV_printf(void *iface, int level,
                             const char *fmt, ...) {
     int ret = 0;
     va_list arg;
+    char msg[LOG_MSG_MAX];
     IFace *iout = reinterpret_cast<IFace *>(iface);
 
-    RISCV_mutex_lock(&mutex_printf);
     if (iout == NULL) {
-        ret = RISCV_sprintf(bufLog, sizeof(bufLog), "[%s]: ", "unknown");
-    } else if (strcmp(iout->getFaceName(), IFACE_SERVICE) == 0) {
+        ret = RISCV_sprintf(msg, sizeof(msg), "[%s]: ", "unknown");
+    } else if (iout->getFaceName() == IFACE_SERVICE
+            || strcmp(iout->getFaceName(), IFACE_SERVICE) == 0) {
         IService *iserv = static_cast<IService *>(iout);
-        AttributeType *local_level = 
-                static_cast<AttributeType *>(iserv->getAttribute("LogLevel"));
-        if (level > static_cast<int>(local_level->to_int64())) {
-            RISCV_mutex_unlock(&mutex_printf);
+        if (level > iserv->getLogLevel()) {
             return 0;
         }
-        ret = RISCV_sprintf(bufLog, sizeof(bufLog), "[%s]: ", 
+        ret = RISCV_sprintf(msg, sizeof(msg), "[%s]: ", 
                                                    iserv->getObjName());
     } else if (strcmp(iout->getFaceName(), IFACE_CLASS) == 0) {
         IClass *icls = static_cast<IClass *>(iout);
-        ret = RISCV_sprintf(bufLog, sizeof(bufLog), "[%s]: ", 
+        ret = RISCV_sprintf(msg, sizeof(msg), "[%s]: ", 
                                                    icls->getClassName());
     } else {
-        ret = RISCV_sprintf(bufLog, sizeof(bufLog), "[%s]: ", 
+        ret = RISCV_sprintf(msg, sizeof(msg), "[%s]: ", 
                                                    iout->getFaceName());
     }
     va_start(arg, fmt);
 #if defined(_WIN32) || defined(__CYGWIN__)
-    ret += vsprintf_s(&bufLog[ret], sizeof(bufLog) - ret, fmt, arg);
+    int len = _vsnprintf_s(&msg[ret], sizeof(msg) - ret - 1, _TRUNCATE,
+                           fmt, arg);
 #else
-    ret += vsprintf(&bufLog[ret], fmt, arg);
+    int len = vsnprintf(&msg[ret], sizeof(msg) - ret - 1, fmt, arg);
 #endif
     va_end(arg);
+#if defined(_WIN32) || defined(__CYGWIN__)
+    if (len < 0) {
+        // Truncated output is terminated with _TRUNCATE
+        len = static_cast<int>(strlen(&msg[ret]));
+    }
+#endif
+    if (len < 0) {
+        len = 0;
+    } else if (len >= static_cast<int>(sizeof(msg)) - ret - 1) {
+        len = static_cast<int>(sizeof(msg)) - ret - 2;
+    }
+    ret += len;
 
-    bufLog[ret++] = '\n';
-    bufLog[ret] = '\0';
-    if (default_console) {
-        default_console->writeBuffer(bufLog);
-    } else {
-        RISCV_print_bin(level, bufLog, ret);
+    msg[ret++] = '\n';
+    msg[ret] = '\0';
+    // Errors and unconditional messages are written immediately
+    if (level > LOG_ERROR && _log_push(msg, ret)) {
+        return ret;
     }
+
+    // Flush buffered messages first to keep their order
+    RISCV_mutex_lock(&mutex_printf);
+    _log_drain();
+    _log_output(level, msg, ret);
     RISCV_mutex_unlock(&mutex_printf);
     return ret;
 }
@@ -119,7 +357,7 @@ extern "C" void RISCV_sleep_ms(int ms) {
 
 extern "C" uint64_t RISCV_get_time_ms() {
 #if defined(_WIN32) || defined(__CYGWIN__)
-    return 1000*(clock()/CLOCKS_PER_SEC);
+    return (1000 * static_cast<uint64_t>(clock())) / CLOCKS_PER_SEC;
 #else
     struct timeval tc;
     gettimeofday(&tc, NULL);
@@ -130,9 +368,61 @@ extern "C" uint64_t RISCV_get_time_ms() {
 extern "C" void RISCV_thread_create(void *data) {
     LibThreadType *p = (LibThreadType *)data;
 #if defined(_WIN32) || defined(__CYGWIN__)
-    p->Handle = (thread_def)_beginthreadex(0, 0, p->func, p->args, 0, 0);
+    p->Handle = (thread_def)_beginthreadex(0, 0, p->func, p->args, 
+                                           CREATE_SUSPENDED, 0);
+    if (!p->Handle) {
+        return;
+    }
+    if (p->affinity) {
+        SetThreadAffinityMask(p->Handle, static_cast<DWORD_PTR>(p->affinity));
+    }
+    if (p->priority > 0) {
+        SetThreadPriority(p->Handle, THREAD_PRIORITY_TIME_CRITICAL);
+    } else if (p->priority < 0) {
+        SetThreadPriority(p->Handle, THREAD_PRIORITY_IDLE);
+    }
+    ResumeThread(p->Handle);
 #else
-    pthread_create(&p->Handle, 0, p->func, p->args);
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    if (p->affinity) {
+        // Pin thread before it starts
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (int i = 0; i < 64 && i < CPU_SETSIZE; i++) {
+            if ((p->affinity >> i) & 0x1) {
+                CPU_SET(i, &cpus);
+            }
+        }
+        pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+    }
+    if (pthread_create(&p->Handle, &attr, p->func, p->args) != 0) {
+        p->Handle = 0;
+        pthread_attr_destroy(&attr);
+        return;
+    }
+    pthread_attr_destroy(&attr);
+
+    if (p->priority != 0) {
+        struct sched_param param;
+        int policy = p->priority > 0 ? SCHED_FIFO : SCHED_IDLE;
+        param.sched_priority = 0;
+        if (p->priority > 0) {
+            param.sched_priority = p->priority;
+            if (param.sched_priority > sched_get_priority_max(SCHED_FIFO)) {
+                param.sched_priority = sched_get_priority_max(SCHED_FIFO);
+            }
+        }
+        if (pthread_setschedparam(p->Handle, policy, &param) != 0) {
+            RISCV_info("Can't change thread priority to %d", p->priority);
+        }
+    }
+    if (p->name) {
+        // Linux limits the name by 16 bytes including zero
+        char name[16];
+        RISCV_sprintf(name, sizeof(name), "%.15s", p->name);
+        pthread_setname_np(p->Handle, name);
+    }
 #endif
 }
 
@@ -164,8 +454,13 @@ extern "C" void RISCV_event_create(event_def *ev, const char *name) {
                 TEXT(name)          // object name
                 ); 
 #else
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    // Timed wait shouldn't depend on the system time adjustment
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
     pthread_mutex_init(&ev->mut, NULL);
-    pthread_cond_init(&ev->cond, NULL);
+    pthread_cond_init(&ev->cond, &attr);
+    pthread_condattr_destroy(&attr);
     ev->state = false;
 #endif
 }
@@ -186,8 +481,9 @@ extern "C" void RISCV_event_set(event_def *ev) {
 #else
     pthread_mutex_lock(&ev->mut);
     ev->state = true;
+    // Manual-reset event: release all waiting threads
+    pthread_cond_broadcast(&ev->cond);
     pthread_mutex_unlock(&ev->mut);
-    pthread_cond_signal(&ev->cond);
 #endif
 }
 
@@ -196,7 +492,9 @@ extern "C" void RISCV_event_clear(event_def *ev) {
     ev->state = false;
     ResetEvent(ev->cond);
 #else
+    pthread_mutex_lock(&ev->mut);
     ev->state = false;
+    pthread_mutex_unlock(&ev->mut);
 #endif
 }
 
@@ -204,10 +502,120 @@ extern "C" void RISCV_event_wait(event_def *ev) {
 #if defined(_WIN32) || defined(__CYGWIN__)
     WaitForSingleObject(ev->cond, INFINITE);
 #else
-    int result = 0;
-    while (result == 0 && !ev->state) {
-        result = pthread_cond_wait(&ev->cond, &ev->mut);
+    pthread_mutex_lock(&ev->mut);
+    while (!ev->state) {
+        pthread_cond_wait(&ev->cond, &ev->mut);
     } 
+    pthread_mutex_unlock(&ev->mut);
+#endif
+}
+
+#if defined(_WIN32) || defined(__CYGWIN__)
+#else
+/** Semaphore wait slice without sem_clockwait(). */
+static const int SEM_WAIT_SLICE_MS = 10;
+
+/** Absolute time for the pthread timed wait functions. */
+static void get_abs_time(clockid_t clk, int ms, struct timespec *ts) {
+    clock_gettime(clk, ts);
+    ts->tv_sec += ms / 1000;
+    ts->tv_nsec += static_cast<long>(ms % 1000) * 1000000;
+    if (ts->tv_nsec >= 1000000000) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000;
+    }
+}
+#endif
+
+extern "C" int RISCV_event_wait_ms(event_def *ev, int ms) {
+#if defined(_WIN32) || defined(__CYGWIN__)
+    if (WaitForSingleObject(ev->cond, ms) == WAIT_TIMEOUT) {
+        return 1;
+    }
+    return 0;
+#else
+    struct timespec ts;
+    int ret = 0;
+    get_abs_time(CLOCK_MONOTONIC, ms, &ts);
+    pthread_mutex_lock(&ev->mut);
+    while (!ev->state && ret == 0) {
+        ret = pthread_cond_timedwait(&ev->cond, &ev->mut, &ts);
+    }
+    ret = ev->state ? 0 : 1;
+    pthread_mutex_unlock(&ev->mut);
+    return ret;
+#endif
+}
+
+extern "C" void RISCV_semaphore_create(semaphore_def *sem, int initial) {
+#if defined(_WIN32) || defined(__CYGWIN__)
+    *sem = CreateSemaphore(NULL, initial, 0x7fffffff, NULL);
+#else
+    sem_init(sem, 0, static_cast<unsigned>(initial));
+#endif
+}
+
+extern "C" void RISCV_semaphore_close(semaphore_def *sem) {
+#if defined(_WIN32) || defined(__CYGWIN__)
+    CloseHandle(*sem);
+#else
+    sem_destroy(sem);
+#endif
+}
+
+extern "C" void RISCV_semaphore_post(semaphore_def *sem) {
+#if defined(_WIN32) || defined(__CYGWIN__)
+    ReleaseSemaphore(*sem, 1, NULL);
+#else
+    sem_post(sem);
+#endif
+}
+
+extern "C" void RISCV_semaphore_wait(semaphore_def *sem) {
+#if defined(_WIN32) || defined(__CYGWIN__)
+    WaitForSingleObject(*sem, INFINITE);
+#else
+    while (sem_wait(sem) != 0 && errno == EINTR) {}
+#endif
+}
+
+extern "C" int RISCV_semaphore_wait_ms(semaphore_def *sem, int ms) {
+#if defined(_WIN32) || defined(__CYGWIN__)
+    if (WaitForSingleObject(*sem, ms) == WAIT_TIMEOUT) {
+        return 1;
+    }
+    return 0;
+#elif defined(__GLIBC__) && (__GLIBC__ > 2 \
+    || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 30))
+    struct timespec ts;
+    int ret;
+    get_abs_time(CLOCK_MONOTONIC, ms, &ts);
+    while ((ret = sem_clockwait(sem, CLOCK_MONOTONIC, &ts)) != 0
+        && errno == EINTR) {}
+    return ret == 0 ? 0 : 1;
+#else
+    // sem_timedwait() counts CLOCK_REALTIME: wait by short slices until
+    // the monotonic deadline, so a wall clock step can't cut the timeout.
+    struct timespec now, end, ts;
+    int64_t left;
+    get_abs_time(CLOCK_MONOTONIC, ms, &end);
+    do {
+        if (sem_trywait(sem) == 0) {
+            return 0;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        left = (end.tv_sec - now.tv_sec) * 1000
+             + (end.tv_nsec - now.tv_nsec) / 1000000;
+        if (left > 0) {
+            get_abs_time(CLOCK_REALTIME,
+                left < SEM_WAIT_SLICE_MS ? static_cast<int>(left)
+                                         : SEM_WAIT_SLICE_MS, &ts);
+            if (sem_timedwait(sem, &ts) == 0) {
+                return 0;
+            }
+        }
+    } while (left > 0);
+    return 1;
 #endif
 }
 
@@ -255,6 +663,62 @@ extern "C" void RISCV_free(void *p) {
     free(p);
 }
 
+/** CRC-32 (IEEE 802.3, reflected polynomial 0xEDB88320) lookup table. */
+static const uint32_t crc32_table_[256] = {
+    0x00000000, 0x77073096, 0xee0e612c, 0x990951ba, 0x076dc419, 0x706af48f,
+    0xe963a535, 0x9e6495a3, 0x0edb8832, 0x79dcb8a4, 0xe0d5e91e, 0x97d2d988,
+    0x09b64c2b, 0x7eb17cbd, 0xe7b82d07, 0x90bf1d91, 0x1db71064, 0x6ab020f2,
+    0xf3b97148, 0x84be41de, 0x1adad47d, 0x6ddde4eb, 0xf4d4b551, 0x83d385c7,
+    0x136c9856, 0x646ba8c0, 0xfd62f97a, 0x8a65c9ec, 0x14015c4f, 0x63066cd9,
+    0xfa0f3d63, 0x8d080df5, 0x3b6e20c8, 0x4c69105e, 0xd56041e4, 0xa2677172,
+    0x3c03e4d1, 0x4b04d447, 0xd20d85fd, 0xa50ab56b, 0x35b5a8fa, 0x42b2986c,
+    0xdbbbc9d6, 0xacbcf940, 0x32d86ce3, 0x45df5c75, 0xdcd60dcf, 0xabd13d59,
+    0x26d930ac, 0x51de003a, 0xc8d75180, 0xbfd06116, 0x21b4f4b5, 0x56b3c423,
+    0xcfba9599, 0xb8bda50f, 0x2802b89e, 0x5f058808, 0xc60cd9b2, 0xb10be924,
+    0x2f6f7c87, 0x58684c11, 0xc1611dab, 0xb6662d3d, 0x76dc4190, 0x01db7106,
+    0x98d220bc, 0xefd5102a, 0x71b18589, 0x06b6b51f, 0x9fbfe4a5, 0xe8b8d433,
+    0x7807c9a2, 0x0f00f934, 0x9609a88e, 0xe10e9818, 0x7f6a0dbb, 0x086d3d2d,
+    0x91646c97, 0xe6635c01, 0x6b6b51f4, 0x1c6c6162, 0x856530d8, 0xf262004e,
+    0x6c0695ed, 0x1b01a57b, 0x8208f4c1, 0xf50fc457, 0x65b0d9c6, 0x12b7e950,
+    0x8bbeb8ea, 0xfcb9887c, 0x62dd1ddf, 0x15da2d49, 0x8cd37cf3, 0xfbd44c65,
+    0x4db26158, 0x3ab551ce, 0xa3bc0074, 0xd4bb30e2, 0x4adfa541, 0x3dd895d7,
+    0xa4d1c46d, 0xd3d6f4fb, 0x4369e96a, 0x346ed9fc, 0xad678846, 0xda60b8d0,
+    0x44042d73, 0x33031de5, 0xaa0a4c5f, 0xdd0d7cc9, 0x5005713c, 0x270241aa,
+    0xbe0b1010, 0xc90c2086, 0x5768b525, 0x206f85b3, 0xb966d409, 0xce61e49f,
+    0x5edef90e, 0x29d9c998, 0xb0d09822, 0xc7d7a8b4, 0x59b33d17, 0x2eb40d81,
+    0xb7bd5c3b, 0xc0ba6cad, 0xedb88320, 0x9abfb3b6, 0x03b6e20c, 0x74b1d29a,
+    0xead54739, 0x9dd277af, 0x04db2615, 0x73dc1683, 0xe3630b12, 0x94643b84,
+    0x0d6d6a3e, 0x7a6a5aa8, 0xe40ecf0b, 0x9309ff9d, 0x0a00ae27, 0x7d079eb1,
+    0xf00f9344, 0x8708a3d2, 0x1e01f268, 0x6906c2fe, 0xf762575d, 0x806567cb,
+    0x196c3671, 0x6e6b06e7, 0xfed41b76, 0x89d32be0, 0x10da7a5a, 0x67dd4acc,
+    0xf9b9df6f, 0x8ebeeff9, 0x17b7be43, 0x60b08ed5, 0xd6d6a3e8, 0xa1d1937e,
+    0x38d8c2c4, 0x4fdff252, 0xd1bb67f1, 0xa6bc5767, 0x3fb506dd, 0x48b2364b,
+    0xd80d2bda, 0xaf0a1b4c, 0x36034af6, 0x41047a60, 0xdf60efc3, 0xa867df55,
+    0x316e8eef, 0x4669be79, 0xcb61b38c, 0xbc66831a, 0x256fd2a0, 0x5268e236,
+    0xcc0c7795, 0xbb0b4703, 0x220216b9, 0x5505262f, 0xc5ba3bbe, 0xb2bd0b28,
+    0x2bb45a92, 0x5cb36a04, 0xc2d7ffa7, 0xb5d0cf31, 0x2cd99e8b, 0x5bdeae1d,
+    0x9b64c2b0, 0xec63f226, 0x756aa39c, 0x026d930a, 0x9c0906a9, 0xeb0e363f,
+    0x72076785, 0x05005713, 0x95bf4a82, 0xe2b87a14, 0x7bb12bae, 0x0cb61b38,
+    0x92d28e9b, 0xe5d5be0d, 0x7cdcefb7, 0x0bdbdf21, 0x86d3d2d4, 0xf1d4e242,
+    0x68ddb3f8, 0x1fda836e, 0x81be16cd, 0xf6b9265b, 0x6fb077e1, 0x18b74777,
+    0x88085ae6, 0xff0f6a70, 0x66063bca, 0x11010b5c, 0x8f659eff, 0xf862ae69,
+    0x616bffd3, 0x166ccf45, 0xa00ae278, 0xd70dd2ee, 0x4e048354, 0x3903b3c2,
+    0xa7672661, 0xd06016f7, 0x4969474d, 0x3e6e77db, 0xaed16a4a, 0xd9d65adc,
+    0x40df0b66, 0x37d83bf0, 0xa9bcae53, 0xdebb9ec5, 0x47b2cf7f, 0x30b5ffe9,
+    0xbdbdf21c, 0xcabac28a, 0x53b39330, 0x24b4a3a6, 0xbad03605, 0xcdd70693,
+    0x54de5729, 0x23d967bf, 0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94,
+    0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
+};
+
+extern "C" uint32_t RISCV_crc32(const void *buf, uint64_t sz, uint32_t crc) {
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(buf);
+    crc = ~crc;
+    for (uint64_t i = 0; i < sz; i++) {
+        crc = crc32_table_[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
 extern "C" int RISCV_get_core_folder(char *out, int sz) {
 #if defined(_WIN32) || defined(__CYGWIN__)
     HMODULE hm = NULL;
@@ -279,21 +743,19 @@ extern "C" int RISCV_get_core_folder(char *out, int sz) {
 }
 
 /**
- * @brief   Loading all plugins from the 'plugins' sub-folder.
+ * @brief   List all plugin libraries from the 'plugins' sub-folder.
  * @details I suppose only one folders level so no itteration algorithm.
+ *          Each item of the output list is [file_name, size, mtime] so that
+ *          the caller can detect modified libraries without opening them.
  */
-void _load_plugins(AttributeType *list) {
-#if defined(_WIN32) || defined(__CYGWIN__)
-    HMODULE hlib;
-#else
-    void *hlib;
-#endif
+void _find_plugins(AttributeType *list) {
     DIR *dir;
     struct dirent *ent;
-    plugin_init_proc plugin_init;
+    struct stat info;
     char curdir[1024];
     std::string plugin_dir, plugin_lib;
 
+    list->make_list(0);
     RISCV_get_core_folder(curdir, sizeof(curdir));
 
     plugin_dir = std::string(curdir) + "plugins/";
@@ -313,45 +775,78 @@ void _load_plugins(AttributeType *list) {
             continue;
         }
         plugin_lib = plugin_dir + std::string(ent->d_name);
-#if defined(_WIN32) || defined(__CYGWIN__)
-        if ((hlib = LoadLibrary(plugin_lib.c_str())) == 0) {
-            continue;
-        }
-        plugin_init = (plugin_init_proc)GetProcAddress(hlib, "plugin_init");
-        if (!plugin_init) {
-            FreeLibrary(hlib);
-            continue;
-        }
-#else
-        // reset errors
-        dlerror();
-        if ((hlib = dlopen(plugin_lib.c_str(), RTLD_LAZY)) == 0) {
-            RISCV_info("Can't open library '%s': %s", 
-                       plugin_lib.c_str(), dlerror());
+        if (stat(plugin_lib.c_str(), &info) != 0) {
             continue;
         }
-        plugin_init = (plugin_init_proc)dlsym(hlib, "plugin_init");
-        if (dlerror()) {
-            RISCV_info("Not found plugin_init() in file '%s'", 
-                       plugin_lib.c_str());
-            dlclose(hlib);
-            continue;
-        }
-#endif
-
-        RISCV_info("Loading plugin file '%s'", plugin_lib.c_str());
-        plugin_init();
 
         AttributeType item;
-        item.make_list(2);
-        item[0u] = AttributeType(plugin_lib.c_str());
-        item[1] = AttributeType(Attr_UInteger, 
-                                reinterpret_cast<uint64_t>(hlib));
+        item.make_list(3);
+        item[0u] = AttributeType(ent->d_name);
+        item[1] = AttributeType(Attr_UInteger,
+                                static_cast<uint64_t>(info.st_size));
+        item[2] = AttributeType(Attr_UInteger,
+                                static_cast<uint64_t>(info.st_mtime));
         list->add_to_list(&item);
     }
     closedir(dir);
 }
 
+/**
+ * @brief   Load plugin library from the 'plugins' sub-folder.
+ * @details Library is registered in the list only if it provides 
+ *          plugin_init() entry point.
+ * @return  true if plugin_init() was called.
+ */
+bool _load_plugin(const char *file, AttributeType *list) {
+#if defined(_WIN32) || defined(__CYGWIN__)
+    HMODULE hlib;
+#else
+    void *hlib;
+#endif
+    plugin_init_proc plugin_init;
+    char curdir[1024];
+    std::string plugin_lib;
+
+    RISCV_get_core_folder(curdir, sizeof(curdir));
+    plugin_lib = std::string(curdir) + "plugins/" + std::string(file);
+#if defined(_WIN32) || defined(__CYGWIN__)
+    if ((hlib = LoadLibrary(plugin_lib.c_str())) == 0) {
+        return false;
+    }
+    plugin_init = (plugin_init_proc)GetProcAddress(hlib, "plugin_init");
+    if (!plugin_init) {
+        FreeLibrary(hlib);
+        return false;
+    }
+#else
+    // reset errors
+    dlerror();
+    if ((hlib = dlopen(plugin_lib.c_str(), RTLD_LAZY)) == 0) {
+        RISCV_info("Can't open library '%s': %s", 
+                   plugin_lib.c_str(), dlerror());
+        return false;
+    }
+    plugin_init = (plugin_init_proc)dlsym(hlib, "plugin_init");
+    if (dlerror()) {
+        RISCV_info("Not found plugin_init() in file '%s'", 
+                   plugin_lib.c_str());
+        dlclose(hlib);
+        return false;
+    }
+#endif
+
+    RISCV_info("Loading plugin file '%s'", plugin_lib.c_str());
+    plugin_init();
+
+    AttributeType item;
+    item.make_list(2);
+    item[0u] = AttributeType(plugin_lib.c_str());
+    item[1] = AttributeType(Attr_UInteger, 
+                            reinterpret_cast<uint64_t>(hlib));
+    list->add_to_list(&item);
+    return true;
+}
+
 void _unload_plugins(AttributeType *list) {
     for (unsigned i = 0; i < list->size(); i++) {
         if (!(*list)[i].is_list()) {
@@ -458,11 +953,13 @@ int RISCV_read_json_file(const char *filename, char *buf, int bufsz) {
     fseek(f, 0, SEEK_END);
     int sz = ftell(f);
     if (sz > bufsz) {
+        fclose(f);
         return 0;
     }
 
     fseek(f, 0, SEEK_SET);
     fread(buf, sz, 1, f);
+    fclose(f);
     return sz;
 }
 
@@ -22,6 +22,8 @@ Bus::Bus(const char *name)
     listMap_.make_list(0);
     imap_.make_list(0);
     breakpoints_.make_list(0);
+    listCpu_.make_list(0);
+    listCpuVersion_ = -1;
 }
 
 Bus::~Bus() {
@@ -57,6 +59,10 @@ int Bus::read(uint64_t addr, uint8_t *payload, int sz) {
     IMemoryOperation *imem;
     Axi4TransactionType memop;
     bool unmapped = true;
+
+    if (sz > BUS_ACCESS_MAX_BYTES) {
+        return burst(addr, payload, sz, false);
+    }
     
     for (unsigned i = 0; i < imap_.size(); i++) {
         imem = static_cast<IMemoryOperation *>(imap_[i].to_iface());
@@ -99,6 +105,10 @@ int Bus::write(uint64_t addr, uint8_t *payload, int sz) {
     Axi4TransactionType memop;
     bool unmapped = true;
 
+    if (sz > BUS_ACCESS_MAX_BYTES) {
+        return burst(addr, payload, sz, true);
+    }
+
     for (unsigned i = 0; i < imap_.size(); i++) {
         imem = static_cast<IMemoryOperation *>(imap_[i].to_iface());
         if (imem->getBaseAddress() <= addr
@@ -135,6 +145,35 @@ int Bus::write(uint64_t addr, uint8_t *payload, int sz) {
     return sz;
 }
 
+/**
+ * @brief Split debugger block access on bus-width transactions.
+ * @details Transaction payload is limited by the AXI data width, so the
+ *          block transfers from TAP are splitted here instead of in each
+ *          transport.
+ */
+int Bus::burst(uint64_t addr, uint8_t *payload, int sz, bool rw) {
+    int total = 0;
+    int chunk;
+    while (total < sz) {
+        chunk = BUS_ACCESS_MAX_BYTES
+              - static_cast<int>(addr & (BUS_ACCESS_MAX_BYTES - 1));
+        if (chunk > sz - total) {
+            chunk = sz - total;
+        }
+        if (rw) {
+            chunk = write(addr, &payload[total], chunk);
+        } else {
+            chunk = read(addr, &payload[total], chunk);
+        }
+        if (chunk == 0) {
+            return 0;
+        }
+        addr += chunk;
+        total += chunk;
+    }
+    return total;
+}
+
 void Bus::addBreakpoint(uint64_t addr) {
     AttributeType br(Attr_UInteger, addr);
     for (unsigned i = 0; i < breakpoints_.size(); i++) {
@@ -158,11 +197,14 @@ void Bus::removeBreakpoint(uint64_t addr) {
 void Bus::checkBreakpoint(uint64_t addr) {
     for (unsigned i = 0; i < breakpoints_.size(); i++) {
         if (addr == breakpoints_[i].to_uint64()) {
-            AttributeType listCpu;
-            RISCV_get_services_with_iface(IFACE_CPU_RISCV, &listCpu);
-            for (unsigned n = 0; n < listCpu.size(); n++) {
+            int version = RISCV_get_registry_version();
+            if (version != listCpuVersion_) {
+                RISCV_get_services_with_iface(IFACE_CPU_RISCV, &listCpu_);
+                listCpuVersion_ = version;
+            }
+            for (unsigned n = 0; n < listCpu_.size(); n++) {
                 ICpuRiscV *iriscv = 
-                    static_cast<ICpuRiscV *>(listCpu[n].to_iface());
+                    static_cast<ICpuRiscV *>(listCpu_[n].to_iface());
                 iriscv->hitBreakpoint(addr);
             }
         }
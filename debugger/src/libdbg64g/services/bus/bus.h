@@ -33,11 +33,18 @@ public:
     virtual void removeBreakpoint(uint64_t addr);
 
 private:
+    /** Transaction width: wider requests are splitted on aligned chunks */
+    static const int BUS_ACCESS_MAX_BYTES = 8;
+
+    int burst(uint64_t addr, uint8_t *payload, int sz, bool rw);
     void checkBreakpoint(uint64_t addr);
 
     AttributeType listMap_;
     AttributeType imap_;
     AttributeType breakpoints_;
+    // CPU handles refreshed when the services registry changes:
+    AttributeType listCpu_;
+    int listCpuVersion_;
     // Clock interface is used just to tag debug output with some step value,
     // in a case of several clocks the first found will be used.
     IClock *iclk0_;
@@ -0,0 +1,278 @@
+/**
+ * @file
+ * @copyright  Copyright 2016 GNSS Sensor Ltd. All right reserved.
+ * @author     Sergey Khabarov - sergeykhbr@gmail.com
+ * @brief      Direct access to the simulated system bus (TAP without EDCL).
+ */
+
+#include "api_core.h"
+#include "bustap.h"
+
+namespace debugger {
+
+/** Class registration in the Core */
+REGISTER_CLASS(BusTapService)
+
+BusTapService::BusTapService(const char *name)
+    : IService(name), IHap(HAP_Halt) {
+    registerInterface(static_cast<ITap *>(this));
+    registerInterface(static_cast<IClockListener *>(this));
+    registerInterface(static_cast<IHap *>(this));
+    registerAttribute("Bus", &bus_);
+    registerAttribute("HwTap", &hwtap_);
+
+    bus_.make_string("");
+    hwtap_.make_string("");
+    ibus_ = 0;
+    ihwtap_ = 0;
+    iclk_ = 0;
+    icpu_ = 0;
+    simEnable_ = false;
+    clk_thread_id_ = 0;
+    req_pending_ = false;
+    req_list_ = 0;
+    req_cnt_ = 0;
+    req_done_ = 0;
+
+    RISCV_mutex_init(&mutex_);
+    RISCV_mutex_init(&mutex_req_);
+    RISCV_semaphore_create(&sem_done_, 0);
+    RISCV_event_create(&event_halt_, "bustap_halt");
+    RISCV_register_hap(static_cast<IHap *>(this));
+}
+
+BusTapService::~BusTapService() {
+    RISCV_event_close(&event_halt_);
+    RISCV_semaphore_close(&sem_done_);
+    RISCV_mutex_destroy(&mutex_req_);
+    RISCV_mutex_destroy(&mutex_);
+}
+
+void BusTapService::postinitService() {
+    const AttributeType *glb = RISCV_get_global_settings();
+    simEnable_ = (*glb)["SimEnable"].to_bool();
+
+    if (hwtap_.size()) {
+        ihwtap_ = static_cast<ITap *>(
+            RISCV_get_service_iface(hwtap_.to_string(), IFACE_TAP));
+        if (!ihwtap_) {
+            RISCV_error("TAP interface '%s' not found", hwtap_.to_string());
+        }
+    }
+
+    ibus_ = static_cast<IBus *>(
+        RISCV_get_service_iface(bus_.to_string(), IFACE_BUS));
+    if (!ibus_ && simEnable_) {
+        RISCV_error("Bus interface '%s' not found", bus_.to_string());
+    }
+
+    AttributeType clks;
+    RISCV_get_clock_services(&clks);
+    if (clks.size()) {
+        iclk_ = static_cast<IClock *>(clks[0u].to_iface());
+    }
+
+    AttributeType cpus;
+    RISCV_get_services_with_iface(IFACE_CPU_RISCV, &cpus);
+    if (cpus.size()) {
+        icpu_ = static_cast<ICpuRiscV *>(cpus[0u].to_iface());
+    }
+}
+
+int BusTapService::read(uint64_t addr, int bytes, uint8_t *obuf) {
+    return transaction(0, addr, bytes, obuf);
+}
+
+int BusTapService::write(uint64_t addr, int bytes, uint8_t *ibuf) {
+    return transaction(1, addr, bytes, ibuf);
+}
+
+int BusTapService::fill(uint64_t addr, int bytes, uint8_t val) {
+    if (!simEnable_ && ihwtap_) {
+        return ihwtap_->fill(addr, bytes, val);
+    }
+    return transaction(2, addr, bytes, &val);
+}
+
+int BusTapService::transaction(int rw, uint64_t addr, int bytes,
+                               uint8_t *buf) {
+    if (!simEnable_) {
+        if (!ihwtap_) {
+            RISCV_error("Simulation disabled and HwTap not defined", NULL);
+            return 0;
+        }
+        return rw ? ihwtap_->write(addr, bytes, buf)
+                  : ihwtap_->read(addr, bytes, buf);
+    }
+    TapRequestType req;
+    req.addr = addr;
+    req.bytes = bytes;
+    req.buf = buf;
+    req.rw = rw;
+    req.result = 0;
+    execute(&req, 1);
+    return req.result;
+}
+
+/**
+ * @brief Scatter-gather access with one step queue handshake.
+ * @details All ranges are executed by one step callback, so the register
+ *          file and a memory window cost the same as a single access.
+ */
+void BusTapService::submit(TapRequestType *reqs, int cnt,
+                           ITapListener *ilistener) {
+    if (!simEnable_ && ihwtap_) {
+        ihwtap_->submit(reqs, cnt, ilistener);
+        return;
+    }
+    TapSubmitType *p = new TapSubmitType;
+    p->itap = this;
+    p->reqs = reqs;
+    p->cnt = cnt;
+    p->ilistener = ilistener;
+    RISCV_submit(runSubmitList, p);
+}
+
+void BusTapService::runSubmitList(void *args) {
+    TapSubmitType *p = reinterpret_cast<TapSubmitType *>(args);
+    BusTapService *ibustap = static_cast<BusTapService *>(p->itap);
+    for (int i = 0; i < p->cnt; i++) {
+        p->reqs[i].result = 0;
+    }
+    if (ibustap->simEnable_) {
+        ibustap->execute(p->reqs, p->cnt);
+    }
+    if (p->ilistener) {
+        p->ilistener->tapCompleted(p->reqs, p->cnt);
+    }
+    delete p;
+}
+
+void BusTapService::execute(TapRequestType *reqs, int cnt) {
+    int done = 0;
+    if (!ibus_) {
+        return;
+    }
+    if (!iclk_ || RISCV_thread_id() == clk_thread_id_) {
+        // Called from the step queue itself: already in the clock thread
+        while (done < cnt) {
+            done += access(&reqs[done], cnt - done);
+        }
+        return;
+    }
+
+    RISCV_mutex_lock(&mutex_);
+    while (done < cnt) {
+        int n = handshake(&reqs[done], cnt - done);
+        if (n == 0) {
+            break;
+        }
+        done += n;
+        if (done < cnt) {
+            waitHalt();
+        }
+    }
+    RISCV_mutex_unlock(&mutex_);
+}
+
+/** @return Number of requests executed by the clock thread. */
+int BusTapService::handshake(TapRequestType *reqs, int cnt) {
+    RISCV_mutex_lock(&mutex_req_);
+    req_list_ = reqs;
+    req_cnt_ = cnt;
+    req_done_ = 0;
+    req_pending_ = true;
+    RISCV_mutex_unlock(&mutex_req_);
+
+    iclk_->registerStepCallback(static_cast<IClockListener *>(this),
+                                iclk_->getStepCounter());
+
+    if (RISCV_semaphore_wait_ms(&sem_done_, BUSTAP_TIMEOUT_MS)) {
+        RISCV_mutex_lock(&mutex_req_);
+        if (req_pending_) {
+            // Cancel so that late step callback won't touch the buffer
+            req_pending_ = false;
+            RISCV_error("Bus access timeout, addr=%08" RV_PRI64 "x",
+                        reqs[0].addr);
+        } else {
+            // Response was posted right after the timeout
+            RISCV_semaphore_wait(&sem_done_);
+        }
+        RISCV_mutex_unlock(&mutex_req_);
+    }
+    return req_done_;
+}
+
+/**
+ * CPU is stepping after the write: the rest of the list is executed when
+ * it halts again, or is late for BUSTAP_STALL_MS if it was 'go'.
+ */
+void BusTapService::waitHalt() {
+    uint64_t t0 = RISCV_get_time_ms();
+    int64_t left = BUSTAP_STALL_MS;
+    while (left > 0) {
+        // Cleared before the check so that the halt can't be missed
+        RISCV_event_clear(&event_halt_);
+        if (icpu_->isHalt()) {
+            break;
+        }
+        RISCV_event_wait_ms(&event_halt_, static_cast<int>(left));
+        left = BUSTAP_STALL_MS
+             - static_cast<int64_t>(RISCV_get_time_ms() - t0);
+    }
+}
+
+void BusTapService::hapTriggered(IFace *isrc, EHapType type,
+                                 const char *descr) {
+    RISCV_event_set(&event_halt_);
+}
+
+void BusTapService::stepCallback(uint64_t t) {
+    clk_thread_id_ = RISCV_thread_id();
+    RISCV_mutex_lock(&mutex_req_);
+    if (req_pending_) {
+        req_done_ = access(req_list_, req_cnt_);
+        req_pending_ = false;
+        RISCV_semaphore_post(&sem_done_);
+    }
+    RISCV_mutex_unlock(&mutex_req_);
+}
+
+/**
+ * @return Number of executed requests. Execution stops after the write
+ *         that resumed the halted CPU, the rest must see it halted again.
+ */
+int BusTapService::access(TapRequestType *reqs, int cnt) {
+    bool halted = icpu_ && icpu_->isHalt();
+    for (int i = 0; i < cnt; i++) {
+        TapRequestType &r = reqs[i];
+        if (r.rw) {
+            r.result = r.rw == 2 ? fillBus(r.addr, r.bytes, r.buf[0])
+                                 : ibus_->write(r.addr, r.buf, r.bytes);
+            if (halted && !icpu_->isHalt()) {
+                return i + 1;
+            }
+        } else {
+            r.result = ibus_->read(r.addr, r.buf, r.bytes);
+        }
+    }
+    return cnt;
+}
+
+/** Memory of the simulated bus is set in the clock thread, no transfer. */
+int BusTapService::fillBus(uint64_t addr, int bytes, uint8_t val) {
+    uint8_t chunk[TAP_FILL_CHUNK_BYTES];
+    int done = 0;
+    memset(chunk, val, sizeof(chunk));
+    while (done < bytes) {
+        int sz = bytes - done;
+        if (sz > TAP_FILL_CHUNK_BYTES) {
+            sz = TAP_FILL_CHUNK_BYTES;
+        }
+        ibus_->write(addr + done, chunk, sz);
+        done += sz;
+    }
+    return done;
+}
+
+}  // namespace debugger
@@ -0,0 +1,98 @@
+/**
+ * @file
+ * @copyright  Copyright 2016 GNSS Sensor Ltd. All right reserved.
+ * @author     Sergey Khabarov - sergeykhbr@gmail.com
+ * @brief      Direct access to the simulated system bus (TAP without EDCL).
+ */
+
+#ifndef __DEBUGGER_BUSTAP_H__
+#define __DEBUGGER_BUSTAP_H__
+
+#include "iclass.h"
+#include "iservice.h"
+#include "ihap.h"
+#include "coreservices/itap.h"
+#include "coreservices/ibus.h"
+#include "coreservices/iclock.h"
+#include "coreservices/iclklistener.h"
+#include "coreservices/icpuriscv.h"
+
+namespace debugger {
+
+/**
+ * @brief ITap bound to the simulated IBus.
+ * @details Transaction is executed by the CPU thread from its step queue
+ *          (the same handshake as Greth does for EDCL packets) so that the
+ *          model is never accessed concurrently. When simulation is disabled
+ *          requests are forwarded to the 'HwTap' service.
+ *          Write that resumed the halted CPU (DSU stepping) holds the rest
+ *          of the request list until the CPU halts again, so that 'step N'
+ *          and the context read are one transfer. The CPU halt is
+ *          signalled by HAP_Halt.
+ */
+class BusTapService : public IService,
+                      public ITap,
+                      public IClockListener,
+                      public IHap {
+public:
+    explicit BusTapService(const char *name);
+    virtual ~BusTapService();
+
+    /** IService interface */
+    virtual void postinitService();
+
+    /** ITap interface */
+    virtual int read(uint64_t addr, int bytes, uint8_t *obuf);
+    virtual int write(uint64_t addr, int bytes, uint8_t *ibuf);
+    virtual int fill(uint64_t addr, int bytes, uint8_t val);
+    virtual void submit(TapRequestType *reqs, int cnt,
+                        ITapListener *ilistener);
+
+    /** IClockListener interface */
+    virtual void stepCallback(uint64_t t);
+
+    /** IHap */
+    virtual void hapTriggered(IFace *isrc, EHapType type, const char *descr);
+
+private:
+    int transaction(int rw, uint64_t addr, int bytes, uint8_t *buf);
+    void execute(TapRequestType *reqs, int cnt);
+    int handshake(TapRequestType *reqs, int cnt);
+    int access(TapRequestType *reqs, int cnt);
+    int fillBus(uint64_t addr, int bytes, uint8_t val);
+    void waitHalt();
+    static void runSubmitList(void *args);
+
+private:
+    /** CPU thread services step queue even when halted, so only a stopped
+     * simulation may leave request without response. */
+    static const int BUSTAP_TIMEOUT_MS = 5000;
+    /** Requests after 'go' aren't held longer than this. */
+    static const int BUSTAP_STALL_MS = 1000;
+
+    AttributeType bus_;
+    AttributeType hwtap_;
+
+    IBus *ibus_;
+    ITap *ihwtap_;
+    IClock *iclk_;
+    ICpuRiscV *icpu_;
+    bool simEnable_;
+    uint64_t clk_thread_id_;
+
+    // Pending request executed in the clock thread:
+    mutex_def mutex_;       // one request at a time
+    mutex_def mutex_req_;   // request state shared with clock thread
+    semaphore_def sem_done_;
+    event_def event_halt_;
+    bool req_pending_;
+    TapRequestType *req_list_;
+    int req_cnt_;
+    int req_done_;
+};
+
+DECLARE_CLASS(BusTapService)
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_BUSTAP_H__
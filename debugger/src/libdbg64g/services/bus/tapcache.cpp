@@ -0,0 +1,269 @@
+/**
+ * @file
+ * @copyright  Copyright 2016 GNSS Sensor Ltd. All right reserved.
+ * @author     Sergey Khabarov - sergeykhbr@gmail.com
+ * @brief      Debugger side memory cache of the TAP accesses.
+ */
+
+#include "api_core.h"
+#include "tapcache.h"
+#include <string.h>
+
+namespace debugger {
+
+/** Class registration in the Core */
+REGISTER_CLASS(TapCacheService)
+
+TapCacheService::TapCacheService(const char *name) : IService(name) {
+    registerInterface(static_cast<ITap *>(this));
+    registerAttribute("Tap", &tap_);
+    registerAttribute("Regions", &regions_);
+    registerAttribute("LineSize", &lineSize_);
+    registerAttribute("MaxLines", &maxLines_);
+    registerAttribute("HaltStatusAddr", &haltStatusAddr_);
+
+    tap_.make_string("");
+    regions_.make_list(0);
+    lineSize_.make_int64(64);
+    maxLines_.make_int64(1024);
+    haltStatusAddr_.make_uint64(0);
+
+    itap_ = 0;
+    line_ = 64;
+    status_valid_ = false;
+    halted_ = false;
+    status_time_ = 0;
+    hits_ = 0;
+    misses_ = 0;
+    RISCV_mutex_init(&mutex_);
+}
+
+TapCacheService::~TapCacheService() {
+    invalidate();
+    RISCV_mutex_destroy(&mutex_);
+}
+
+void TapCacheService::postinitService() {
+    itap_ = static_cast<ITap *>(
+        RISCV_get_service_iface(tap_.to_string(), IFACE_TAP));
+    if (!itap_) {
+        RISCV_error("TAP interface '%s' not found", tap_.to_string());
+    }
+
+    line_ = lineSize_.to_uint64();
+    if (line_ < 8 || (line_ & (line_ - 1)) != 0) {
+        RISCV_error("Wrong line size %d, use 64 bytes",
+                    static_cast<int>(line_));
+        line_ = 64;
+    }
+}
+
+void TapCacheService::predeleteService() {
+    RISCV_info("Line hits %" RV_PRI64 "d, misses %" RV_PRI64 "d",
+                hits_, misses_);
+}
+
+int TapCacheService::read(uint64_t addr, int bytes, uint8_t *obuf) {
+    if (!itap_) {
+        return 0;
+    }
+    uint64_t start = addr & ~(line_ - 1);
+    uint64_t end = (addr + bytes + line_ - 1) & ~(line_ - 1);
+    uint64_t la;
+    int ret;
+
+    RISCV_mutex_lock(&mutex_);
+    if (bytes <= 0 || !isCacheable(start, end)
+        || (end - start) / line_ > CACHE_BYPASS_LINES || !isHalted()) {
+        ret = itap_->read(addr, bytes, obuf);
+        snoopStatus(addr, bytes, obuf);
+        RISCV_mutex_unlock(&mutex_);
+        return ret;
+    }
+
+    if (lines_.size() + (end - start) / line_ > maxLines_.to_uint64()) {
+        invalidateRange(0, ~0ull);
+    }
+
+    // Fetch missing lines, adjacent lines with one transfer
+    la = start;
+    while (la < end) {
+        if (lines_.find(la) != lines_.end()) {
+            hits_++;
+            la += line_;
+            continue;
+        }
+        uint64_t miss_start = la;
+        while (la < end && lines_.find(la) == lines_.end()) {
+            misses_++;
+            la += line_;
+        }
+        if (fetch(miss_start, la) == 0) {
+            ret = itap_->read(addr, bytes, obuf);
+            RISCV_mutex_unlock(&mutex_);
+            return ret;
+        }
+    }
+
+    for (la = start; la < end; la += line_) {
+        uint64_t s = addr > la ? addr : la;
+        uint64_t e = (addr + bytes) < (la + line_) ? (addr + bytes)
+                                                   : (la + line_);
+        memcpy(&obuf[s - addr], &lines_[la][s - la], e - s);
+    }
+    RISCV_mutex_unlock(&mutex_);
+    return bytes;
+}
+
+int TapCacheService::write(uint64_t addr, int bytes, uint8_t *ibuf) {
+    if (!itap_) {
+        return 0;
+    }
+    uint64_t start = addr & ~(line_ - 1);
+    uint64_t end = (addr + bytes + line_ - 1) & ~(line_ - 1);
+    int ret;
+
+    RISCV_mutex_lock(&mutex_);
+    ret = itap_->write(addr, bytes, ibuf);
+    if (isCacheable(start, end)) {
+        invalidateRange(start, end);
+    } else {
+        // Run control, stepping, CSRs: target state is unknown
+        invalidate();
+    }
+    RISCV_mutex_unlock(&mutex_);
+    return ret;
+}
+
+int TapCacheService::fill(uint64_t addr, int bytes, uint8_t val) {
+    if (!itap_) {
+        return 0;
+    }
+    uint64_t start = addr & ~(line_ - 1);
+    uint64_t end = (addr + bytes + line_ - 1) & ~(line_ - 1);
+    int ret;
+
+    RISCV_mutex_lock(&mutex_);
+    ret = itap_->fill(addr, bytes, val);
+    if (isCacheable(start, end)) {
+        invalidateRange(start, end);
+    } else {
+        invalidate();
+    }
+    RISCV_mutex_unlock(&mutex_);
+    return ret;
+}
+
+void TapCacheService::submit(TapRequestType *reqs, int cnt,
+                             ITapListener *ilistener) {
+    bool has_write = false;
+    bool uncached = false;
+    for (int i = 0; i < cnt; i++) {
+        uint64_t start = reqs[i].addr & ~(line_ - 1);
+        uint64_t end = (reqs[i].addr + reqs[i].bytes + line_ - 1)
+                     & ~(line_ - 1);
+        has_write |= reqs[i].rw != 0;
+        uncached |= !isCacheable(start, end);
+    }
+    if (!itap_ || (!has_write && !uncached)) {
+        // Cached read() of each range
+        ITap::submit(reqs, cnt, ilistener);
+        return;
+    }
+    if (!has_write) {
+        // Registers of the running target (trace, status) in one transfer
+        itap_->submit(reqs, cnt, ilistener);
+        return;
+    }
+    RISCV_mutex_lock(&mutex_);
+    invalidate();
+    RISCV_mutex_unlock(&mutex_);
+    itap_->submit(reqs, cnt, new SubmitRelay(this, ilistener));
+}
+
+void TapCacheService::SubmitRelay::tapCompleted(TapRequestType *reqs,
+                                                int cnt) {
+    RISCV_mutex_lock(&p_->mutex_);
+    p_->invalidate();
+    RISCV_mutex_unlock(&p_->mutex_);
+    if (ilistener_) {
+        ilistener_->tapCompleted(reqs, cnt);
+    }
+    delete this;
+}
+
+bool TapCacheService::isCacheable(uint64_t addr, uint64_t end) {
+    for (unsigned i = 0; i < regions_.size(); i++) {
+        const AttributeType &r = regions_[i];
+        uint64_t base = r[0u].to_uint64();
+        if (addr >= base && end <= base + r[1].to_uint64()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TapCacheService::isHalted() {
+    uint64_t status_addr = haltStatusAddr_.to_uint64();
+    if (status_addr == 0) {
+        return false;
+    }
+    // Target may be resumed by other clients (EDCL host), halt isn't final
+    uint64_t t = RISCV_get_time_ms();
+    if (status_valid_ && (t - status_time_) < CACHE_RUN_RECHECK_MS) {
+        return halted_;
+    }
+    uint8_t val[8] = {0};
+    if (itap_->read(status_addr, 8, val) <= 0) {
+        return false;
+    }
+    snoopStatus(status_addr, 8, val);
+    return halted_;
+}
+
+/** Update target state if the read data contains run control register. */
+void TapCacheService::snoopStatus(uint64_t addr, int bytes, uint8_t *buf) {
+    uint64_t status_addr = haltStatusAddr_.to_uint64();
+    if (status_addr == 0 || status_addr < addr
+        || status_addr >= addr + bytes) {
+        return;
+    }
+    halted_ = (buf[status_addr - addr] & 0x1) != 0;
+    if (!halted_) {
+        // Memory is changing while target is running
+        invalidateRange(0, ~0ull);
+    }
+    status_valid_ = true;
+    status_time_ = RISCV_get_time_ms();
+}
+
+int TapCacheService::fetch(uint64_t addr, uint64_t end) {
+    int sz = static_cast<int>(end - addr);
+    uint8_t *buf = new uint8_t[sz];
+    if (itap_->read(addr, sz, buf) != sz) {
+        delete [] buf;
+        return 0;
+    }
+    for (uint64_t la = addr; la < end; la += line_) {
+        uint8_t *line = new uint8_t[line_];
+        memcpy(line, &buf[la - addr], line_);
+        lines_[la] = line;
+    }
+    delete [] buf;
+    return sz;
+}
+
+void TapCacheService::invalidate() {
+    invalidateRange(0, ~0ull);
+    status_valid_ = false;
+}
+
+void TapCacheService::invalidateRange(uint64_t addr, uint64_t end) {
+    std::map<uint64_t, uint8_t *>::iterator it = lines_.lower_bound(addr);
+    while (it != lines_.end() && it->first < end) {
+        delete [] it->second;
+        lines_.erase(it++);
+    }
+}
+
+}  // namespace debugger
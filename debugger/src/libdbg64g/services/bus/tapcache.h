@@ -0,0 +1,95 @@
+/**
+ * @file
+ * @copyright  Copyright 2016 GNSS Sensor Ltd. All right reserved.
+ * @author     Sergey Khabarov - sergeykhbr@gmail.com
+ * @brief      Debugger side memory cache of the TAP accesses.
+ */
+
+#ifndef __DEBUGGER_TAPCACHE_H__
+#define __DEBUGGER_TAPCACHE_H__
+
+#include "iclass.h"
+#include "iservice.h"
+#include "coreservices/itap.h"
+#include <map>
+
+namespace debugger {
+
+/**
+ * @brief Caching ITap decorator.
+ * @details Reads from the 'Regions' list are fetched by 'LineSize' aligned
+ *          lines and all missing adjacent lines of one request are merged
+ *          into a single transfer of the 'Tap' service. Lines are valid only
+ *          while the target is halted: halt bit is read from 'HaltStatusAddr'
+ *          (0 disables caching) and re-checked every CACHE_RUN_RECHECK_MS.
+ *          Any write outside of the cached regions (run, step, CSR) drops
+ *          the whole snapshot, writes into regions drop affected lines.
+ *          Submitted lists with writes or reads outside of the regions
+ *          go to the 'Tap' as is, to keep step and context read, or
+ *          trace counter and entries, in one transfer.
+ */
+class TapCacheService : public IService,
+                        public ITap {
+public:
+    explicit TapCacheService(const char *name);
+    virtual ~TapCacheService();
+
+    /** IService interface */
+    virtual void postinitService();
+    virtual void predeleteService();
+
+    /** ITap interface */
+    virtual int read(uint64_t addr, int bytes, uint8_t *obuf);
+    virtual int write(uint64_t addr, int bytes, uint8_t *ibuf);
+    virtual int fill(uint64_t addr, int bytes, uint8_t val);
+    virtual void submit(TapRequestType *reqs, int cnt,
+                        ITapListener *ilistener);
+
+private:
+    /** Drops the snapshot once more when the forwarded list completed. */
+    class SubmitRelay : public ITapListener {
+    public:
+        SubmitRelay(TapCacheService *p, ITapListener *ilistener)
+            : p_(p), ilistener_(ilistener) {}
+        virtual void tapCompleted(TapRequestType *reqs, int cnt);
+    private:
+        TapCacheService *p_;
+        ITapListener *ilistener_;
+    };
+
+
+    bool isCacheable(uint64_t addr, uint64_t end);
+    bool isHalted();
+    void snoopStatus(uint64_t addr, int bytes, uint8_t *buf);
+    int fetch(uint64_t addr, uint64_t end);
+    void invalidate();
+    void invalidateRange(uint64_t addr, uint64_t end);
+
+private:
+    /** Status of the target is re-read not often than this. */
+    static const int CACHE_RUN_RECHECK_MS = 100;
+    /** Block reads larger than this number of lines aren't cached. */
+    static const int CACHE_BYPASS_LINES = 16;
+
+    AttributeType tap_;
+    AttributeType regions_;
+    AttributeType lineSize_;
+    AttributeType maxLines_;
+    AttributeType haltStatusAddr_;
+
+    ITap *itap_;
+    mutex_def mutex_;
+    uint64_t line_;
+    std::map<uint64_t, uint8_t *> lines_;
+    bool status_valid_;
+    bool halted_;
+    uint64_t status_time_;
+    uint64_t hits_;
+    uint64_t misses_;
+};
+
+DECLARE_CLASS(TapCacheService)
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_TAPCACHE_H__
@@ -6,6 +6,7 @@
  */
 
 #include <string.h>
+#include <stdlib.h>
 #include "cmdparser.h"
 #include "coreservices/ithread.h"
 
@@ -26,6 +27,25 @@ union DsuRunControlRegType {
     uint8_t  buf[8];
 };
 
+/** DSU context block: registers are indexed the same as 'RegNames'. */
+struct DsuCpuContextType {
+    uint64_t regs[32];
+    uint64_t pc;
+    uint64_t npc;
+    uint64_t step_counter;
+    uint64_t halted;
+    uint64_t csr[8];
+    uint64_t rsv[4];
+};
+
+/** DSU trace buffer entry. */
+struct DsuTraceEntryType {
+    uint64_t step;
+    uint64_t pc;
+    uint64_t instr;
+    uint64_t rsv;
+};
+
 enum RegListType {REG_Name, REG_IDx};
 
 CmdParserService::CmdParserService(const char *name) 
@@ -45,9 +65,11 @@ CmdParserService::CmdParserService(const char *name)
     regNames_.make_list(0);
     tmpbuf_ = new uint8_t[tmpbuf_size_ = 4096];
     outbuf_ = new char[outbuf_size_ = 4096];
+    RISCV_event_create(&tap_done_, "cmd_tap_done");
 }
 
 CmdParserService::~CmdParserService() {
+    RISCV_event_close(&tap_done_);
     delete [] tmpbuf_;
     delete [] outbuf_;
 }
@@ -57,6 +79,8 @@ void CmdParserService::postinitService() {
             (RISCV_get_service_iface(tap_.to_string(), IFACE_TAP));
     iloader_ = static_cast<IElfLoader *>
             (RISCV_get_service_iface(loader_.to_string(), IFACE_ELFLOADER));
+    isymtbl_ = static_cast<ISymbolTable *>
+            (RISCV_get_service_iface(loader_.to_string(), IFACE_SYMBOL_TABLE));
 
     for (unsigned i = 0; i < console_.size(); i++) {
         IConsole *icls = static_cast<IConsole *>
@@ -104,8 +128,11 @@ void CmdParserService::processLine(const char *line) {
         outf("      stop/break/s    - Stop simulation\n");
         outf("      run/go/c  - Run simulation for a specify "
                                "number of steps\n");
+        outf("      step      - Step N instructions and print context\n");
         outf("      regs      - List of registers values\n");
+        outf("      trace     - Last executed instructions\n");
         outf("      br        - Breakpoint operation\n");
+        outf("      speed     - Simulation speed mode and ratio\n");
         outf("\n");
     } else if (strcmp(listArgs[0u].to_string(), "loadelf") == 0) {
         if (listArgs.size() == 2) {
@@ -194,11 +221,13 @@ void CmdParserService::processLine(const char *line) {
             outf("Description:\n");
             outf("    32-bits aligned memory reading. "
                         "Default bytes = 4 bytes.\n");
+            outf("    Address may be a symbol of the loaded ELF-file.\n");
             outf("Usage:\n");
-            outf("    read <addr> <bytes>\n");
+            outf("    read <addr|symbol[+offset]> <bytes>\n");
             outf("Example:\n");
             outf("    read 0xfffff004 16\n");
             outf("    read 0xfffff004\n");
+            outf("    read main+0x10 16\n");
         }
     } else if (strcmp(listArgs[0u].to_string(), "exit") == 0) {
         RISCV_break_simulation();
@@ -231,6 +260,34 @@ void CmdParserService::processLine(const char *line) {
             outf("    go 1000\n");
             outf("    c 1\n");
         }
+    } else if (strcmp(listArgs[0u].to_string(), "step") == 0) {
+        if (listArgs.size() == 1 
+            || (listArgs.size() == 2 && listArgs[1].is_integer())) {
+            step(&listArgs);
+        } else {
+            outf("Description:\n");
+            outf("    Step N instructions (default 1) and print CPU "
+                        "context.\n");
+            outf("Usage:\n");
+            outf("    step <N steps>\n");
+            outf("Example:\n");
+            outf("    step\n");
+            outf("    step 10\n");
+        }
+    } else if (strcmp(listArgs[0u].to_string(), "trace") == 0) {
+        if (listArgs.size() == 1 
+            || (listArgs.size() == 2 && listArgs[1].is_integer())) {
+            trace(&listArgs);
+        } else {
+            outf("Description:\n");
+            outf("    Print last N executed instructions (default 16) "
+                        "from the CPU trace buffer.\n");
+            outf("Usage:\n");
+            outf("    trace <N>\n");
+            outf("Example:\n");
+            outf("    trace\n");
+            outf("    trace 100\n");
+        }
     } else if (strcmp(listArgs[0u].to_string(), "br") == 0) {
         if (listArgs.size() == 3 && listArgs[1].is_string()) {
             br(&listArgs);
@@ -238,11 +295,28 @@ void CmdParserService::processLine(const char *line) {
             outf("Description:\n");
             outf("    Add or remove memory breakpoint.\n");
             outf("Usage:\n");
-            outf("    br add <addr>\n");
-            outf("    br rm <addr>\n");
+            outf("    br add <addr|symbol[+offset]>\n");
+            outf("    br rm <addr|symbol[+offset]>\n");
             outf("Example:\n");
             outf("    br add 0x10000000\n");
             outf("    br rm 0x10000000\n");
+            outf("    br add main\n");
+        }
+    } else if (strcmp(listArgs[0u].to_string(), "speed") == 0) {
+        if (listArgs.size() == 1
+            || (listArgs.size() == 2 && listArgs[1].is_string()
+                && (strcmp(listArgs[1].to_string(), "max") == 0
+                || strcmp(listArgs[1].to_string(), "realtime") == 0))) {
+            speed(&listArgs);
+        } else {
+            outf("Description:\n");
+            outf("    Print simulated to wall time ratio or change mode.\n");
+            outf("Usage:\n");
+            outf("    speed\n");
+            outf("    speed <max|realtime>\n");
+            outf("Example:\n");
+            outf("    speed\n");
+            outf("    speed realtime\n");
         }
     } else {
         outf("Use 'help' to print list of the supported commands\n");
@@ -353,7 +427,11 @@ void CmdParserService::writeCSR(AttributeType *listArgs) {
 
 void CmdParserService::readMem(AttributeType *listArgs) {
     uint64_t addr_start, addr_end, inv_i;
-    uint64_t addr = (*listArgs)[1].to_uint64();
+    uint64_t addr;
+    if (!getAddress(&(*listArgs)[1], &addr)) {
+        outf("Unknown symbol '%s'\n", (*listArgs)[1].to_string());
+        return;
+    }
     int bytes = static_cast<int>((*listArgs)[2].to_uint64());
     if (bytes > tmpbuf_size_) {
         delete [] tmpbuf_;
@@ -467,11 +545,12 @@ void CmdParserService::run(AttributeType *listArgs) {
 }
 
 void CmdParserService::regs(AttributeType *listArgs) {
-    uint64_t addr = DSU_CTRL_BASE_ADDRESS + 64*8;   // CPU register array
-    uint64_t regs[128] = {0};
-    for (unsigned i = 1; i < regNames_.size(); i++) {
-        itap_->read(addr + 8*i, 8, reinterpret_cast<uint8_t *>(&regs[i]));
-    }
+    // CPU context block: all registers with one burst
+    uint64_t addr = DSU_CTRL_BASE_ADDRESS + DSU_CONTEXT_OFFSET;
+    DsuCpuContextType ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    itap_->read(addr, sizeof(ctx), reinterpret_cast<uint8_t *>(&ctx));
+    uint64_t *regs = reinterpret_cast<uint64_t *>(&ctx);
     outf("ra: %016" RV_PRI64 "x    \n", regs[getRegIDx("ra")]);
 
     outf("                        ", NULL);
@@ -521,8 +600,98 @@ void CmdParserService::regs(AttributeType *listArgs) {
     outf("npc: %016" RV_PRI64 "x   \n", regs[getRegIDx("npc")]);
 }
 
+/**
+ * Step and context read are submitted as one list: bus tap executes the
+ * read when the CPU has finished stepping.
+ */
+void CmdParserService::step(AttributeType *listArgs) {
+    uint64_t steps = 1;
+    DsuCpuContextType ctx;
+    TapRequestType reqs[2];
+    if (listArgs->size() == 2) {
+        steps = (*listArgs)[1].to_uint64();
+    }
+    memset(&ctx, 0, sizeof(ctx));
+    reqs[0].addr = DSU_CTRL_BASE_ADDRESS + DSU_STEP_CTX_OFFSET;
+    reqs[0].bytes = 8;
+    reqs[0].buf = reinterpret_cast<uint8_t *>(&steps);
+    reqs[0].rw = 1;
+    reqs[1].addr = DSU_CTRL_BASE_ADDRESS + DSU_CONTEXT_OFFSET;
+    reqs[1].bytes = sizeof(ctx);
+    reqs[1].buf = reinterpret_cast<uint8_t *>(&ctx);
+    reqs[1].rw = 0;
+    tapTransfer(reqs, 2);
+
+    outf("[%" RV_PRI64 "d] pc: %016" RV_PRI64 "x   npc: %016" RV_PRI64 "x"
+         "   %s\n", ctx.step_counter, ctx.pc, ctx.npc,
+         ctx.halted & 0x1 ? "halted" : "running");
+}
+
+/** Trace registers and entries are read with one request list. */
+void CmdParserService::trace(AttributeType *listArgs) {
+    unsigned total = 16;
+    uint64_t info[2] = {0};     // trace_size, trace_count
+    TapRequestType reqs[2];
+    if (listArgs->size() == 2) {
+        total = static_cast<unsigned>((*listArgs)[1].to_uint64());
+    }
+    if (total > DSU_TRACE_ENTRIES_MAX) {
+        total = DSU_TRACE_ENTRIES_MAX;
+    }
+    if (total == 0) {
+        return;
+    }
+    DsuTraceEntryType *entries = new DsuTraceEntryType[total];
+    reqs[0].addr = DSU_CTRL_BASE_ADDRESS + DSU_TRACE_INFO_OFFSET;
+    reqs[0].bytes = sizeof(info);
+    reqs[0].buf = reinterpret_cast<uint8_t *>(info);
+    reqs[0].rw = 0;
+    reqs[1].addr = DSU_CTRL_BASE_ADDRESS + DSU_TRACE_OFFSET;
+    reqs[1].bytes = total * sizeof(DsuTraceEntryType);
+    reqs[1].buf = reinterpret_cast<uint8_t *>(entries);
+    reqs[1].rw = 0;
+    tapTransfer(reqs, 2);
+
+    if (info[0] == 0) {
+        outf("Trace disabled, set 'TraceSize' of the CPU\n");
+        delete [] entries;
+        return;
+    }
+    if (total > info[0]) {
+        total = static_cast<unsigned>(info[0]);
+    }
+    if (total > info[1]) {
+        total = static_cast<unsigned>(info[1]);
+    }
+    // Oldest first
+    for (unsigned i = total; i > 0; i--) {
+        DsuTraceEntryType &e = entries[i - 1];
+        uint64_t offset;
+        const char *symb = isymtbl_ ? isymtbl_->findSymbol(e.pc, &offset)
+                                    : NULL;
+        outf("[%" RV_PRI64 "d] %016" RV_PRI64 "x: %08x",
+             e.step, e.pc, static_cast<uint32_t>(e.instr));
+        if (symb) {
+            outf("  <%s+0x%" RV_PRI64 "x>", symb, offset);
+        }
+        int line;
+        const char *file = isymtbl_ ? isymtbl_->findLine(e.pc, &line)
+                                    : NULL;
+        if (file) {
+            const char *base = strrchr(file, '/');
+            outf("  %s:%d", base ? base + 1 : file, line);
+        }
+        outf("\n");
+    }
+    delete [] entries;
+}
+
 void CmdParserService::br(AttributeType *listArgs) {
-    uint64_t value = (*listArgs)[2].to_uint64();
+    uint64_t value;
+    if (!getAddress(&(*listArgs)[2], &value)) {
+        outf("Unknown symbol '%s'\n", (*listArgs)[2].to_string());
+        return;
+    }
     if (strcmp((*listArgs)[1].to_string(), "add") == 0) {
         // CPU add_breakpoint register
         uint64_t dsu_off = DSU_CTRL_BASE_ADDRESS + 16;
@@ -533,6 +702,32 @@ void CmdParserService::br(AttributeType *listArgs) {
     }
 }
 
+void CmdParserService::speed(AttributeType *listArgs) {
+    // DSU speed_ratio and speed_mode registers
+    uint64_t dsu_off = DSU_CTRL_BASE_ADDRESS + 32;
+    uint64_t value;
+    if (listArgs->size() == 2) {
+        value = strcmp((*listArgs)[1].to_string(), "realtime") == 0 ? 1 : 0;
+        itap_->write(dsu_off + 8, 8, reinterpret_cast<uint8_t *>(&value));
+        return;
+    }
+    itap_->read(dsu_off + 8, 8, reinterpret_cast<uint8_t *>(&value));
+    outf("Mode: %s\n", value ? "realtime" : "max");
+    itap_->read(dsu_off, 8, reinterpret_cast<uint8_t *>(&value));
+    outf("Simulated/wall time: %.3f\n", static_cast<double>(value) / 1000.0);
+}
+
+/** Submit scatter-gather request and wait its completion. */
+void CmdParserService::tapTransfer(TapRequestType *reqs, int cnt) {
+    RISCV_event_clear(&tap_done_);
+    itap_->submit(reqs, cnt, static_cast<ITapListener *>(this));
+    RISCV_event_wait(&tap_done_);
+}
+
+void CmdParserService::tapCompleted(TapRequestType *reqs, int cnt) {
+    RISCV_event_set(&tap_done_);
+}
+
 unsigned CmdParserService::getRegIDx(const char *name) {
     for (unsigned i = 0; i < regNames_.size(); i++) {
         if (strcmp(name, regNames_[i][REG_Name].to_string()) == 0) {
@@ -557,4 +752,27 @@ int CmdParserService::outf(const char *fmt, ...) {
     return outbuf_cnt_;
 }
 
+/** Integer address or symbol name with optional '+offset' suffix. */
+bool CmdParserService::getAddress(AttributeType *arg, uint64_t *addr) {
+    if (arg->is_integer()) {
+        *addr = arg->to_uint64();
+        return true;
+    }
+    if (!arg->is_string() || !isymtbl_) {
+        return false;
+    }
+    std::string name(arg->to_string());
+    uint64_t offset = 0;
+    size_t plus = name.find('+');
+    if (plus != std::string::npos) {
+        offset = strtoull(name.c_str() + plus + 1, NULL, 0);
+        name.resize(plus);
+    }
+    if (!isymtbl_->findAddress(name.c_str(), addr)) {
+        return false;
+    }
+    *addr += offset;
+    return true;
+}
+
 }  // namespace debugger
@@ -15,13 +15,15 @@
 #include "coreservices/iconsolelistener.h"
 #include "coreservices/itap.h"
 #include "coreservices/ielfloader.h"
+#include "coreservices/isymtable.h"
 #include <string>
 #include <stdarg.h>
 
 namespace debugger {
 
 class CmdParserService : public IService,
-                         public IConsoleListener {
+                         public IConsoleListener,
+                         public ITapListener {
 public:
     explicit CmdParserService(const char *name);
     virtual ~CmdParserService();
@@ -33,10 +35,20 @@ public:
     virtual void udpateCommand(const char *line);
     virtual void autocompleteCommand(const char *line) {}
 
+    /** ITapListener */
+    virtual void tapCompleted(TapRequestType *reqs, int cnt);
+
 private:
     static const uint64_t DSU_BASE_ADDRESS = 0x80080000;
     // Valid only for simulation.
     static const uint64_t DSU_CTRL_BASE_ADDRESS = 0x80090000;
+    // Step N instructions register and read-only CPU context block
+    static const uint64_t DSU_STEP_CTX_OFFSET = 0x310;
+    static const uint64_t DSU_CONTEXT_OFFSET = 0x400;
+    // Trace buffer size/count registers and entries (latest first)
+    static const uint64_t DSU_TRACE_INFO_OFFSET = 0x580;
+    static const uint64_t DSU_TRACE_OFFSET = 0x8000;
+    static const unsigned DSU_TRACE_ENTRIES_MAX = 1024;
 
     void processLine(const char *line);
     void splitLine(char *str, AttributeType *listArgs);
@@ -69,10 +81,15 @@ private:
     void halt(AttributeType *listArgs);
     void run(AttributeType *listArgs);
     void regs(AttributeType *listArgs);
+    void step(AttributeType *listArgs);
+    void trace(AttributeType *listArgs);
     void br(AttributeType *listArgs);
+    void speed(AttributeType *listArgs);
     unsigned getRegIDx(const char *name);
+    bool getAddress(AttributeType *arg, uint64_t *addr);
 
     int outf(const char *fmt, ...);
+    void tapTransfer(TapRequestType *reqs, int cnt);
 
 private:
     AttributeType console_;
@@ -85,6 +102,8 @@ private:
     AttributeType iconsoles_;
     ITap *itap_;
     IElfLoader *iloader_;
+    ISymbolTable *isymtbl_;
+    event_def tap_done_;
     std::string cmdLine_;
     char cmdbuf_[4096];
     char *outbuf_;
@@ -33,6 +33,7 @@ static const uint8_t UNICODE_BACKSPACE = 0x7f;
 ConsoleService::ConsoleService(const char *name) 
     : IService(name), IHap(HAP_ConfigDone) {
     registerInterface(static_cast<IThread *>(this));
+    registerThreadAttributes(this);
     registerInterface(static_cast<IConsole *>(this));
     registerInterface(static_cast<IHap *>(this));
     registerInterface(static_cast<IRawListener *>(this));
@@ -43,9 +44,11 @@ ConsoleService::ConsoleService(const char *name)
     registerAttribute("Serial", &serial_);
     registerAttribute("History", &history_);
     registerAttribute("HistorySize", &history_size_);
+    registerAttribute("Reactor", &reactor_);
 
     RISCV_mutex_init(&mutexConsoleOutput_);
     RISCV_event_create(&config_done_, "config_done");
+    RISCV_event_create(&input_ready_, "console_input");
     RISCV_register_hap(static_cast<IHap *>(this));
 
     isEnable_.make_boolean(true);
@@ -56,6 +59,8 @@ ConsoleService::ConsoleService(const char *name)
     consoleListeners_.make_list(0);
     history_.make_list(0);
     history_size_.make_int64(4);
+    reactor_.make_string("");
+    ireactor_ = NULL;
     history_idx_ = 0;
 
     logfile_ = NULL;
@@ -92,6 +97,7 @@ ConsoleService::~ConsoleService() {
 #else
     tcsetattr(STDIN, TCSANOW, &original_settings_);
 #endif
+    RISCV_event_close(&input_ready_);
     RISCV_event_close(&config_done_);
     RISCV_mutex_destroy(&mutexConsoleOutput_);
 }
@@ -103,6 +109,18 @@ void ConsoleService::postinitService() {
         uart->registerRawListener(static_cast<IRawListener *>(this));
     }
 
+#if defined(_WIN32) || defined(__CYGWIN__)
+#else
+    if (reactor_.size()) {
+        IReactor *ireactor = static_cast<IReactor *>(
+            RISCV_get_service_iface(reactor_.to_string(), IFACE_REACTOR));
+        if (ireactor && ireactor->registerReadHandler(term_fd_,
+                        static_cast<IReactorListener *>(this)) == 0) {
+            ireactor_ = ireactor;
+        }
+    }
+#endif
+
     if (isEnable_.to_bool()) {
         if (!run()) {
             RISCV_error("Can't create thread.", NULL);
@@ -139,6 +157,23 @@ void ConsoleService::postinitService() {
 
 void ConsoleService::predeleteService() {
     stop();
+#if defined(_WIN32) || defined(__CYGWIN__)
+#else
+    if (ireactor_) {
+        ireactor_->unregisterReadHandler(term_fd_);
+        ireactor_ = NULL;
+    }
+#endif
+}
+
+void ConsoleService::stop() {
+    loopEnable_ = false;
+    RISCV_event_set(&input_ready_);
+    IThread::stop();
+}
+
+void ConsoleService::readyRead(socket_def fd) {
+    RISCV_event_set(&input_ready_);
 }
 
 void ConsoleService::stepCallback(uint64_t t) {
@@ -204,6 +239,15 @@ void ConsoleService::busyLoop() {
 
     processScriptFile();
     while (isEnabled()) {
+        if (ireactor_) {
+            // Notification is edge triggered: read all symbols before wait
+            RISCV_event_clear(&input_ready_);
+            while (isData() && isEnabled()) {
+                addToCommandLine(getData());
+            }
+            RISCV_event_wait(&input_ready_);
+            continue;
+        }
         if (isData()) {
             addToCommandLine(getData());
         }
@@ -18,6 +18,7 @@
 #include "coreservices/iconsolelistener.h"
 #include "coreservices/irawlistener.h"
 #include "coreservices/isignallistener.h"
+#include "coreservices/ireactor.h"
 #include <string>
 //#define DBG_ZEPHYR
 
@@ -30,7 +31,8 @@ class ConsoleService : public IService,
                        public IHap,
                        public IRawListener,
                        public ISignalListener,
-                       public IClockListener {
+                       public IClockListener,
+                       public IReactorListener {
 public:
     explicit ConsoleService(const char *name);
     virtual ~ConsoleService();
@@ -56,6 +58,12 @@ public:
     /** ISignalListener */
     virtual void updateSignal(int start, int width, uint64_t value);
 
+    /** IReactorListener */
+    virtual void readyRead(socket_def fd);
+
+    /** IThread interface */
+    virtual void stop();
+
 protected:
     /** IThread interface */
     virtual void busyLoop();
@@ -79,8 +87,11 @@ private:
     AttributeType serial_;
     AttributeType history_;
     AttributeType history_size_;
+    AttributeType reactor_;
 
     event_def config_done_;
+    event_def input_ready_;
+    IReactor *ireactor_;
     mutex_def mutexConsoleOutput_;
     IClock *iclk_;
     char tmpbuf_[4096];
@@ -0,0 +1,450 @@
+/**
+ * @file
+ * @copyright  Copyright 2016 GNSS Sensor Ltd. All right reserved.
+ * @author     Sergey Khabarov - sergeykhbr@gmail.com
+ * @brief      DWARF line number table (.debug_line) implementation.
+ */
+
+#include "dwarfline.h"
+#include <algorithm>
+#include <string.h>
+
+namespace debugger {
+
+// Standard opcodes:
+static const uint8_t DW_LNS_copy                = 1;
+static const uint8_t DW_LNS_advance_pc          = 2;
+static const uint8_t DW_LNS_advance_line        = 3;
+static const uint8_t DW_LNS_set_file            = 4;
+static const uint8_t DW_LNS_const_add_pc        = 8;
+static const uint8_t DW_LNS_fixed_advance_pc    = 9;
+// Extended opcodes:
+static const uint8_t DW_LNE_end_sequence        = 1;
+static const uint8_t DW_LNE_set_address         = 2;
+static const uint8_t DW_LNE_define_file         = 3;
+// Entry content types (DWARF 5):
+static const uint64_t DW_LNCT_path              = 1;
+static const uint64_t DW_LNCT_directory_index   = 2;
+// Attribute forms:
+static const uint64_t DW_FORM_addr              = 0x01;
+static const uint64_t DW_FORM_block2            = 0x03;
+static const uint64_t DW_FORM_block4            = 0x04;
+static const uint64_t DW_FORM_data2             = 0x05;
+static const uint64_t DW_FORM_data4             = 0x06;
+static const uint64_t DW_FORM_data8             = 0x07;
+static const uint64_t DW_FORM_string            = 0x08;
+static const uint64_t DW_FORM_block             = 0x09;
+static const uint64_t DW_FORM_block1            = 0x0a;
+static const uint64_t DW_FORM_data1             = 0x0b;
+static const uint64_t DW_FORM_flag              = 0x0c;
+static const uint64_t DW_FORM_sdata             = 0x0d;
+static const uint64_t DW_FORM_strp              = 0x0e;
+static const uint64_t DW_FORM_udata             = 0x0f;
+static const uint64_t DW_FORM_strx              = 0x1a;
+static const uint64_t DW_FORM_data16            = 0x1e;
+static const uint64_t DW_FORM_line_strp         = 0x1f;
+static const uint64_t DW_FORM_strx1             = 0x25;
+static const uint64_t DW_FORM_strx2             = 0x26;
+static const uint64_t DW_FORM_strx3             = 0x27;
+static const uint64_t DW_FORM_strx4             = 0x28;
+
+/** File index of rows without source file. */
+static const uint32_t FILE_UNKNOWN = ~0u;
+
+bool DwarfLineTable::parse(const DwarfSectionsType *sec) {
+    rows_.clear();
+    files_.clear();
+    fileIdx_.clear();
+
+    const uint8_t *unit = sec->line;
+    const uint8_t *end = sec->line + sec->line_size;
+    while (unit && unit < end) {
+        unit = parseUnit(sec, unit);
+    }
+
+    /**
+     * Stable sort keeps the program order of the equal addresses, the last
+     * emitted row is kept unless it only ends a sequence. Rows that don't
+     * change file or line are dropped, they are covered by the previous row.
+     */
+    std::stable_sort(rows_.begin(), rows_.end(), lessRow);
+    std::vector<LineRowType> compact;
+    for (size_t i = 0; i < rows_.size(); i++) {
+        const LineRowType &r = rows_[i];
+        if (!compact.empty() && compact.back().addr == r.addr) {
+            if (r.line != 0 || compact.back().line == 0) {
+                compact.back() = r;
+            }
+        } else if (compact.empty() || compact.back().file != r.file
+                || compact.back().line != r.line) {
+            compact.push_back(r);
+        }
+    }
+    rows_.swap(compact);
+    return !rows_.empty();
+}
+
+const char *DwarfLineTable::findLine(uint64_t addr, int *line) {
+    std::vector<LineRowType>::iterator it =
+        std::upper_bound(rows_.begin(), rows_.end(), addr, lessRowAddr);
+    if (it == rows_.begin()) {
+        return NULL;
+    }
+    --it;
+    if (it->line == 0 || it->file == FILE_UNKNOWN) {
+        return NULL;
+    }
+    *line = static_cast<int>(it->line);
+    return files_[it->file].c_str();
+}
+
+/** @return next unit or NULL if the section is broken. */
+const uint8_t *DwarfLineTable::parseUnit(const DwarfSectionsType *sec,
+                                         const uint8_t *unit) {
+    CursorType c = {unit, sec->line + sec->line_size, false};
+    bool dwarf64 = false;
+    uint64_t len = readU(&c, 4);
+    if (len == 0xffffffffull) {
+        dwarf64 = true;
+        len = readU(&c, 8);
+    }
+    if (c.err || len > static_cast<uint64_t>(c.end - c.p)) {
+        return NULL;
+    }
+    const uint8_t *next = c.p + len;
+    c.end = next;
+
+    int version = static_cast<int>(readU(&c, 2));
+    if (version < 2 || version > 5) {
+        return next;
+    }
+    int addr_size = 8;
+    if (version >= 5) {
+        addr_size = static_cast<int>(readU(&c, 1));
+        readU(&c, 1);                           // segment selector size
+    }
+    uint64_t header_len = readU(&c, dwarf64 ? 8 : 4);
+    if (c.err || header_len > static_cast<uint64_t>(c.end - c.p)) {
+        return next;
+    }
+    const uint8_t *program = c.p + header_len;
+    uint64_t min_inst = readU(&c, 1);
+    if (version >= 4) {
+        readU(&c, 1);                           // maximum_operations
+    }
+    readU(&c, 1);                               // default_is_stmt
+    int line_base = static_cast<int8_t>(readU(&c, 1));
+    int line_range = static_cast<int>(readU(&c, 1));
+    int opcode_base = static_cast<int>(readU(&c, 1));
+    std::vector<uint8_t> std_len(opcode_base + 1, 0);
+    for (int i = 1; i < opcode_base; i++) {
+        std_len[i] = static_cast<uint8_t>(readU(&c, 1));
+    }
+
+    std::vector<std::string> dirs;
+    std::vector<std::string> names;
+    std::vector<uint64_t> name_dir;
+    if (version >= 5) {
+        std::vector<uint64_t> unused;
+        readEntries(&c, sec, dwarf64, addr_size, &dirs, &unused);
+        readEntries(&c, sec, dwarf64, addr_size, &names, &name_dir);
+    } else {
+        // Index 0 is the compilation directory and file is 1-based
+        dirs.push_back("");
+        while (!c.err && c.p < c.end && *c.p) {
+            dirs.push_back(readStr(&c));
+        }
+        readU(&c, 1);
+        names.push_back("");
+        name_dir.push_back(0);
+        while (!c.err && c.p < c.end && *c.p) {
+            names.push_back(readStr(&c));
+            name_dir.push_back(readULEB(&c));
+            readULEB(&c);                       // modification time
+            readULEB(&c);                       // file length
+        }
+        readU(&c, 1);
+    }
+    if (c.err || line_range == 0 || opcode_base == 0) {
+        return next;
+    }
+
+    std::vector<uint32_t> file_id(names.size());
+    for (size_t i = 0; i < names.size(); i++) {
+        const std::string &dir = name_dir[i] < dirs.size()
+                                ? dirs[static_cast<size_t>(name_dir[i])] : "";
+        file_id[i] = internFile(dir, names[i].c_str());
+    }
+
+    // Line number program state machine
+    c.p = program;
+    uint64_t addr = 0;
+    uint64_t file = 1;
+    int64_t line = 1;
+    LineRowType row;
+    while (!c.err && c.p < c.end) {
+        uint8_t op = static_cast<uint8_t>(readU(&c, 1));
+        bool emit = false;
+        bool end_seq = false;
+        if (op >= opcode_base) {
+            int adj = op - opcode_base;
+            addr += (adj / line_range) * min_inst;
+            line += line_base + adj % line_range;
+            emit = true;
+        } else if (op == 0) {
+            uint64_t ext_len = readULEB(&c);
+            if (c.err || ext_len == 0
+                || ext_len > static_cast<uint64_t>(c.end - c.p)) {
+                break;
+            }
+            const uint8_t *ext_end = c.p + ext_len;
+            uint8_t ext = static_cast<uint8_t>(readU(&c, 1));
+            if (ext == DW_LNE_end_sequence) {
+                emit = true;
+                end_seq = true;
+            } else if (ext == DW_LNE_set_address) {
+                addr = readU(&c, static_cast<int>(ext_len - 1));
+            } else if (ext == DW_LNE_define_file) {
+                const char *name = readStr(&c);
+                uint64_t dir = readULEB(&c);
+                file_id.push_back(internFile(
+                    dir < dirs.size() ? dirs[static_cast<size_t>(dir)] : "",
+                    name));
+            }
+            c.p = ext_end;
+        } else if (op == DW_LNS_copy) {
+            emit = true;
+        } else if (op == DW_LNS_advance_pc) {
+            addr += readULEB(&c) * min_inst;
+        } else if (op == DW_LNS_advance_line) {
+            line += readSLEB(&c);
+        } else if (op == DW_LNS_set_file) {
+            file = readULEB(&c);
+        } else if (op == DW_LNS_const_add_pc) {
+            addr += ((255 - opcode_base) / line_range) * min_inst;
+        } else if (op == DW_LNS_fixed_advance_pc) {
+            addr += readU(&c, 2);
+        } else {
+            // Other opcodes don't change address, file or line
+            for (int i = 0; i < std_len[op]; i++) {
+                readULEB(&c);
+            }
+        }
+
+        if (emit && !c.err) {
+            row.addr = addr;
+            row.file = file < file_id.size()
+                     ? file_id[static_cast<size_t>(file)] : FILE_UNKNOWN;
+            row.line = end_seq || line < 0 ? 0 : static_cast<uint32_t>(line);
+            rows_.push_back(row);
+        }
+        if (end_seq) {
+            addr = 0;
+            file = 1;
+            line = 1;
+        }
+    }
+    return next;
+}
+
+/** DWARF 5 directory or file name entries described by formats list. */
+bool DwarfLineTable::readEntries(CursorType *c, const DwarfSectionsType *sec,
+                                 bool dwarf64, int addr_size,
+                                 std::vector<std::string> *paths,
+                                 std::vector<uint64_t> *dirs) {
+    std::vector<uint64_t> fmt;      // pairs of content type and form
+    unsigned fmt_cnt = static_cast<unsigned>(readU(c, 1));
+    for (unsigned i = 0; i < 2 * fmt_cnt; i++) {
+        fmt.push_back(readULEB(c));
+    }
+    uint64_t cnt = readULEB(c);
+    for (uint64_t n = 0; n < cnt && !c->err; n++) {
+        const char *path = "";
+        uint64_t dir = 0;
+        for (unsigned i = 0; i < fmt_cnt && !c->err; i++) {
+            uint64_t type = fmt[2 * i];
+            uint64_t form = fmt[2 * i + 1];
+            if (type == DW_LNCT_path && form == DW_FORM_string) {
+                path = readStr(c);
+            } else if (type == DW_LNCT_path && form == DW_FORM_line_strp) {
+                path = sectionStr(sec->line_str, sec->line_str_size,
+                                  readU(c, dwarf64 ? 8 : 4));
+            } else if (type == DW_LNCT_path && form == DW_FORM_strp) {
+                path = sectionStr(sec->str, sec->str_size,
+                                  readU(c, dwarf64 ? 8 : 4));
+            } else if (type == DW_LNCT_directory_index
+                    && form == DW_FORM_udata) {
+                dir = readULEB(c);
+            } else if (type == DW_LNCT_directory_index
+                    && form == DW_FORM_data1) {
+                dir = readU(c, 1);
+            } else if (type == DW_LNCT_directory_index
+                    && form == DW_FORM_data2) {
+                dir = readU(c, 2);
+            } else if (!skipForm(c, form, dwarf64, addr_size)) {
+                c->err = true;
+            }
+        }
+        paths->push_back(path);
+        dirs->push_back(dir);
+    }
+    return !c->err;
+}
+
+uint32_t DwarfLineTable::internFile(const std::string &dir,
+                                    const char *name) {
+    std::string path;
+    bool absolute = name[0] == '/' || name[0] == '\\'
+                 || (name[0] && name[1] == ':');
+    if (absolute || dir.empty()) {
+        path = name;
+    } else {
+        path = dir + "/" + name;
+    }
+    std::pair<std::unordered_map<std::string, uint32_t>::iterator, bool>
+        res = fileIdx_.insert(std::make_pair(path,
+                              static_cast<uint32_t>(files_.size())));
+    if (res.second) {
+        files_.push_back(path);
+    }
+    return res.first->second;
+}
+
+uint64_t DwarfLineTable::readU(CursorType *c, int bytes) {
+    uint64_t ret = 0;
+    if (bytes < 0 || bytes > 8 || c->end - c->p < bytes) {
+        c->err = true;
+        return 0;
+    }
+    for (int i = 0; i < bytes; i++) {
+        ret |= static_cast<uint64_t>(c->p[i]) << (8 * i);
+    }
+    c->p += bytes;
+    return ret;
+}
+
+uint64_t DwarfLineTable::readULEB(CursorType *c) {
+    uint64_t ret = 0;
+    int shift = 0;
+    while (c->p < c->end) {
+        uint8_t b = *c->p++;
+        if (shift < 64) {
+            ret |= static_cast<uint64_t>(b & 0x7f) << shift;
+        }
+        shift += 7;
+        if ((b & 0x80) == 0) {
+            return ret;
+        }
+    }
+    c->err = true;
+    return 0;
+}
+
+int64_t DwarfLineTable::readSLEB(CursorType *c) {
+    uint64_t ret = 0;
+    int shift = 0;
+    while (c->p < c->end) {
+        uint8_t b = *c->p++;
+        if (shift < 64) {
+            ret |= static_cast<uint64_t>(b & 0x7f) << shift;
+        }
+        shift += 7;
+        if ((b & 0x80) == 0) {
+            if (shift < 64 && (b & 0x40)) {
+                ret |= ~0ull << shift;
+            }
+            return static_cast<int64_t>(ret);
+        }
+    }
+    c->err = true;
+    return 0;
+}
+
+const char *DwarfLineTable::readStr(CursorType *c) {
+    const char *ret = reinterpret_cast<const char *>(c->p);
+    const uint8_t *nul = static_cast<const uint8_t *>(
+                            memchr(c->p, 0, c->end - c->p));
+    if (!nul) {
+        c->err = true;
+        return "";
+    }
+    c->p = nul + 1;
+    return ret;
+}
+
+const char *DwarfLineTable::sectionStr(const uint8_t *buf, uint64_t size,
+                                       uint64_t off) {
+    if (!buf || off >= size || !memchr(buf + off, 0, size - off)) {
+        return "";
+    }
+    return reinterpret_cast<const char *>(buf + off);
+}
+
+bool DwarfLineTable::skipForm(CursorType *c, uint64_t form, bool dwarf64,
+                              int addr_size) {
+    uint64_t block = 0;
+    switch (form) {
+    case DW_FORM_addr:
+        readU(c, addr_size);
+        break;
+    case DW_FORM_block:
+        block = readULEB(c);
+        break;
+    case DW_FORM_block1:
+        block = readU(c, 1);
+        break;
+    case DW_FORM_block2:
+        block = readU(c, 2);
+        break;
+    case DW_FORM_block4:
+        block = readU(c, 4);
+        break;
+    case DW_FORM_data1:
+    case DW_FORM_flag:
+    case DW_FORM_strx1:
+        readU(c, 1);
+        break;
+    case DW_FORM_data2:
+    case DW_FORM_strx2:
+        readU(c, 2);
+        break;
+    case DW_FORM_strx3:
+        readU(c, 3);
+        break;
+    case DW_FORM_data4:
+    case DW_FORM_strx4:
+        readU(c, 4);
+        break;
+    case DW_FORM_data8:
+        readU(c, 8);
+        break;
+    case DW_FORM_data16:
+        readU(c, 8);
+        readU(c, 8);
+        break;
+    case DW_FORM_string:
+        readStr(c);
+        break;
+    case DW_FORM_strp:
+    case DW_FORM_line_strp:
+        readU(c, dwarf64 ? 8 : 4);
+        break;
+    case DW_FORM_udata:
+    case DW_FORM_strx:
+        readULEB(c);
+        break;
+    case DW_FORM_sdata:
+        readSLEB(c);
+        break;
+    default:
+        return false;
+    }
+    if (block > static_cast<uint64_t>(c->end - c->p)) {
+        c->err = true;
+    } else {
+        c->p += block;
+    }
+    return !c->err;
+}
+
+}  // namespace debugger
@@ -0,0 +1,94 @@
+/**
+ * @file
+ * @copyright  Copyright 2016 GNSS Sensor Ltd. All right reserved.
+ * @author     Sergey Khabarov - sergeykhbr@gmail.com
+ * @brief      DWARF line number table (.debug_line) declaration.
+ */
+
+#ifndef __DEBUGGER_DWARF_LINE_H__
+#define __DEBUGGER_DWARF_LINE_H__
+
+#include <inttypes.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace debugger {
+
+/** Sections used by the line table decoder, size = 0 if absent. */
+struct DwarfSectionsType {
+    const uint8_t *line;        // .debug_line
+    uint64_t line_size;
+    const uint8_t *line_str;    // .debug_line_str (DWARF 5)
+    uint64_t line_str_size;
+    const uint8_t *str;         // .debug_str
+    uint64_t str_size;
+};
+
+/**
+ * @brief Address sorted table of source lines.
+ * @details Line number programs of DWARF versions 2..5 are executed and
+ *          only rows changing file or line are kept. File paths are
+ *          interned, so the table doesn't depend on the file image.
+ */
+class DwarfLineTable {
+public:
+    DwarfLineTable() {}
+
+    /** @return false if no line program was decoded. */
+    bool parse(const DwarfSectionsType *sec);
+
+    /** @return file path of the address or NULL. */
+    const char *findLine(uint64_t addr, int *line);
+
+    unsigned getRowCount() { return static_cast<unsigned>(rows_.size()); }
+    unsigned getFileCount() { return static_cast<unsigned>(files_.size()); }
+
+private:
+    /** Row starts address range of the line, line = 0 ends sequence. */
+    struct LineRowType {
+        uint64_t addr;
+        uint32_t file;
+        uint32_t line;
+    };
+
+    /** Read pointer of the section with the bounds check. */
+    struct CursorType {
+        const uint8_t *p;
+        const uint8_t *end;
+        bool err;
+    };
+
+    static bool lessRow(const LineRowType &a, const LineRowType &b) {
+        return a.addr < b.addr;
+    }
+    static bool lessRowAddr(uint64_t addr, const LineRowType &b) {
+        return addr < b.addr;
+    }
+
+    const uint8_t *parseUnit(const DwarfSectionsType *sec,
+                             const uint8_t *unit);
+    bool readEntries(CursorType *c, const DwarfSectionsType *sec,
+                     bool dwarf64, int addr_size,
+                     std::vector<std::string> *paths,
+                     std::vector<uint64_t> *dirs);
+    uint32_t internFile(const std::string &dir, const char *name);
+
+    static uint64_t readU(CursorType *c, int bytes);
+    static uint64_t readULEB(CursorType *c);
+    static int64_t readSLEB(CursorType *c);
+    static const char *readStr(CursorType *c);
+    static const char *sectionStr(const uint8_t *buf, uint64_t size,
+                                  uint64_t off);
+    bool skipForm(CursorType *c, uint64_t form, bool dwarf64,
+                  int addr_size);
+
+private:
+    std::vector<LineRowType> rows_;
+    std::vector<std::string> files_;
+    std::unordered_map<std::string, uint32_t> fileIdx_;
+};
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_DWARF_LINE_H__
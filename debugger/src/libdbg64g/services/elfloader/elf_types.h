@@ -105,6 +105,7 @@ static const Elf32_Word SHT_HIUSER    = 0xffffffff;
 static const Elf32_Word SHF_WRITE     = 0x1;        // section contains data that should be writable during process execution.
 static const Elf32_Word SHF_ALLOC     = 0x2;        // section occupies memory during process execution. 
 static const Elf32_Word SHF_EXECINSTR = 0x4;        // section contains executable machine instructions.
+static const Elf32_Word SHF_COMPRESSED = 0x800;      // section data is compressed.
 static const Elf32_Word SHF_MASKPROC  = 0xf0000000; // processor-specific sematic
 
 typedef struct SectionHeaderType
@@ -140,6 +141,10 @@ static const unsigned char STT_FILE    = 4;
 static const unsigned char STT_LOPROC  = 13;
 static const unsigned char STT_HIPROC  = 15;
 
+//st_shndx:
+static const Elf32_Half SHN_UNDEF   = 0;
+static const Elf32_Half SHN_ABS     = 0xfff1;
+
 typedef struct SymbolTableType
 {
     Elf32_Word    st_name;
@@ -151,6 +156,16 @@ typedef struct SymbolTableType
 } SymbolTableType;
 
 
+typedef struct NoteHeaderType
+{
+    Elf32_Word    n_namesz;
+    Elf32_Word    n_descsz;
+    Elf32_Word    n_type;
+} NoteHeaderType;
+
+//n_type:
+static const Elf32_Word NT_GNU_BUILD_ID = 3;
+
 //p_type:
 static const Elf32_Word PT_NULL     = 0;
 static const Elf32_Word PT_LOAD     = 1;
@@ -164,13 +179,13 @@ static const Elf32_Word PT_HIPROC   = 0x7fffffff;
 
 typedef struct ProgramHeaderType
 {
-  uint32_t    p_type;
-  uint32_t    p_offset;
+  Elf32_Word  p_type;
+  Elf32_Word  p_flags;      // ELF64: flags follow type
+  uint64_t    p_offset;
   uint64_t    p_vaddr;
   uint64_t    p_paddr;
   uint64_t    p_filesz;
   uint64_t    p_memsz;
-  uint64_t    p_flags;
   uint64_t    p_align;
 } ProgramHeaderType;
 
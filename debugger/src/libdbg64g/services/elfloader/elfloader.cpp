@@ -7,6 +7,15 @@
 
 #include "elfloader.h"
 #include <iostream>
+#include <algorithm>
+#include <string.h>
+#if defined(_WIN32) || defined(__CYGWIN__)
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace debugger {
 
@@ -15,18 +24,42 @@ REGISTER_CLASS(ElfLoaderService)
 
 ElfLoaderService::ElfLoaderService(const char *name) : IService(name) {
     registerInterface(static_cast<IElfLoader *>(this));
+    registerInterface(static_cast<ISymbolTable *>(this));
+    registerInterface(static_cast<ITapListener *>(this));
     registerAttribute("Tap", &tap_);
     registerAttribute("VerifyEna", &verify_ena_);
+    registerAttribute("DeltaLoad", &deltaLoad_);
+    registerAttribute("PageSize", &pageSize_);
+    registerAttribute("CrcDsuAddress", &crcDsuAddress_);
+    registerAttribute("TrustCache", &trustCache_);
     tap_.make_string("");
     verify_ena_.make_boolean(false);
+    deltaLoad_.make_boolean(false);
+    pageSize_.make_uint64(4096);
+    crcDsuAddress_.make_uint64(0);
+    trustCache_.make_boolean(false);
+    RISCV_event_create(&tap_done_, "elfloader_tap_done");
+    RISCV_mutex_init(&mutexSymbols_);
+    target_crc_ = false;
+    page_ = 4096;
+    pages_total_ = 0;
+    pages_written_ = 0;
     itap_ = 0;
     image_ = NULL;
+    image_size_ = 0;
+    mapped_ = false;
     sectionNames_ = NULL;
+    symbolNames_ = NULL;
+    lines_ = NULL;
 }
 
 ElfLoaderService::~ElfLoaderService() {
-    if (image_) {
-        delete image_;
+    unmapFile();
+    RISCV_event_close(&tap_done_);
+    RISCV_mutex_destroy(&mutexSymbols_);
+    for (std::map<std::string, DwarfLineTable *>::iterator
+            it = lineCache_.begin(); it != lineCache_.end(); ++it) {
+        delete it->second;
     }
 }
 
@@ -40,67 +73,206 @@ void ElfLoaderService::postinitService() {
     if (!itap_) {
         RISCV_error("ITap interface '%s' not found", tap_.to_string());
     }
+
+    page_ = pageSize_.to_uint64();
+    if (page_ < 64 || page_ > VERIFY_CHUNK_BYTES) {
+        RISCV_error("Wrong page size %d, use 4096 bytes",
+                    static_cast<int>(page_));
+        page_ = 4096;
+    }
 }
 
 int ElfLoaderService::loadFile(const char *filename) {
-    FILE *fp = fopen(filename, "rb");
-    if (!fp) {
-        RISCV_error("File '%s' not found", filename);
+    unmapFile();
+    if (!mapFile(filename)) {
         return -1;
     }
-    fseek(fp, 0, SEEK_END);
-    int sz = ftell(fp);
-    rewind(fp);
-
-    if (image_) {
-        delete image_;
-        sectionNames_ = NULL;
-    }
-    image_ = new uint8_t[sz];
-    fread(image_, 1, sz, fp);
 
-    readElfHeader();
-
-    if (!header_->e_shoff) {
-        fclose(fp);
-        return 0;
+    if (!readElfHeader()) {
+        unmapFile();
+        return -1;
     }
 
     /** Init names */
-    SectionHeaderType *sh;
-    sh_tbl_ = reinterpret_cast<SectionHeaderType *>
-                                (&image_[header_->e_shoff]);
-    for (int i = 0; i < header_->e_shnum; i++) {
-        sh = &sh_tbl_[i];
-        if (sh->sh_type == SHT_STRTAB) {
-            processStringTable(sh);
+    RISCV_mutex_lock(&mutexSymbols_);
+    symbols_.clear();
+    symbolAddr_.clear();
+    if (header_->e_shoff) {
+        SectionHeaderType *sh;
+        sh_tbl_ = reinterpret_cast<SectionHeaderType *>
+                                    (&image_[header_->e_shoff]);
+        if (header_->e_shstrndx < header_->e_shnum
+            && sh_tbl_[header_->e_shstrndx].sh_offset < image_size_) {
+            sh = &sh_tbl_[header_->e_shstrndx];
+            sectionNames_ = reinterpret_cast<char *>(&image_[sh->sh_offset]);
+        }
+        for (int i = 0; i < header_->e_shnum; i++) {
+            sh = &sh_tbl_[i];
+            if (sh->sh_type == SHT_STRTAB && i != header_->e_shstrndx) {
+                processStringTable(sh);
+            } else if (sh->sh_type == SHT_SYMTAB
+                    || sh->sh_type == SHT_DYNSYM) {
+                processDebugSymbol(sh);
+            }
         }
     }
+    std::sort(symbols_.begin(), symbols_.end(), lessSymbol);
+    processDebugLines();
+    RISCV_mutex_unlock(&mutexSymbols_);
 
     /** Direct loading via tap interface: */
-    int bytes_loaded = loadSections();
+    pages_total_ = 0;
+    pages_written_ = 0;
+    if (deltaLoad_.to_bool() || verify_ena_.to_bool()) {
+        target_crc_ = probeTargetCrc();
+    }
+    int bytes_loaded;
+    if (header_->e_phoff && header_->e_phnum) {
+        bytes_loaded = loadSegments();
+    } else {
+        bytes_loaded = loadSections();
+    }
     RISCV_info("Loaded: %d B", bytes_loaded);
-
-    if (header_->e_phoff) {
-        //readProgramHeader();
+    if (pages_total_) {
+        RISCV_info("Pages written %" RV_PRI64 "d of %" RV_PRI64 "d",
+                   pages_written_, pages_total_);
     }
+    return 0;
+}
 
+bool ElfLoaderService::mapFile(const char *filename) {
+#if defined(_WIN32) || defined(__CYGWIN__)
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) {
+        RISCV_error("File '%s' not found", filename);
+        return false;
+    }
+    fseek(fp, 0, SEEK_END);
+    image_size_ = ftell(fp);
+    rewind(fp);
+    image_ = new uint8_t[static_cast<unsigned>(image_size_)];
+    fread(image_, 1, static_cast<size_t>(image_size_), fp);
     fclose(fp);
-    return 0;
+    mapped_ = false;
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        RISCV_error("File '%s' not found", filename);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        RISCV_error("Can't get size of '%s'", filename);
+        close(fd);
+        return false;
+    }
+    void *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // Mapping stays valid after descriptor is closed
+    close(fd);
+    if (p == MAP_FAILED) {
+        RISCV_error("Can't map file '%s'", filename);
+        return false;
+    }
+    image_ = reinterpret_cast<uint8_t *>(p);
+    image_size_ = st.st_size;
+    mapped_ = true;
+#endif
+    return true;
+}
+
+void ElfLoaderService::unmapFile() {
+    if (!image_) {
+        return;
+    }
+#if defined(_WIN32) || defined(__CYGWIN__)
+    delete [] image_;
+#else
+    if (mapped_) {
+        munmap(image_, image_size_);
+    } else {
+        delete [] image_;
+    }
+#endif
+    image_ = NULL;
+    image_size_ = 0;
+    sectionNames_ = NULL;
+    symbolNames_ = NULL;
 }
 
-void ElfLoaderService::readElfHeader() {
+bool ElfLoaderService::readElfHeader() {
     header_ = reinterpret_cast<ElfHeaderType *>(image_);
+    if (image_size_ < sizeof(ElfHeaderType)) {
+        RISCV_error("File format is not ELF", NULL);
+        return false;
+    }
     for (int i = 0; i < 4; i++) {
         if (header_->e_ident[i] != MAGIC_BYTES[i]) {
             RISCV_error("File format is not ELF", NULL);
-            return;
+            return false;
         }
     }
+    if (header_->e_phoff && header_->e_phnum
+        && (header_->e_phentsize < sizeof(ProgramHeaderType)
+        || header_->e_phoff + static_cast<uint64_t>(header_->e_phnum)
+                * header_->e_phentsize > image_size_)) {
+        RISCV_error("Program headers are out of file", NULL);
+        return false;
+    }
+    if (header_->e_shoff
+        && header_->e_shoff + static_cast<uint64_t>(header_->e_shnum)
+                * sizeof(SectionHeaderType) > image_size_) {
+        RISCV_error("Section headers are out of file", NULL);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Load PT_LOAD segments.
+ * @details Segments are sorted by physical address. File images adjacent
+ *          both in memory and in file, and adjacent zero-filled tails are
+ *          merged so that each continuous range costs one TAP write.
+ */
+int ElfLoaderService::loadSegments() {
+    std::vector<LoadRangeType> ranges;
+    ProgramHeaderType *ph;
+    LoadRangeType r;
+    uint64_t total_bytes = 0;
+
+    for (int i = 0; i < header_->e_phnum; i++) {
+        ph = reinterpret_cast<ProgramHeaderType *>(&image_[
+                header_->e_phoff + i * header_->e_phentsize]);
+        if (ph->p_type != PT_LOAD || ph->p_memsz == 0) {
+            continue;
+        }
+        if (ph->p_offset + ph->p_filesz > image_size_) {
+            RISCV_error("Segment %d is out of file", i);
+            continue;
+        }
+        if (ph->p_filesz) {
+            r.addr = ph->p_paddr;
+            r.buf = &image_[ph->p_offset];
+            r.size = ph->p_filesz;
+            ranges.push_back(r);
+        }
+        if (ph->p_memsz > ph->p_filesz) {
+            r.addr = ph->p_paddr + ph->p_filesz;
+            r.buf = NULL;
+            r.size = ph->p_memsz - ph->p_filesz;
+            ranges.push_back(r);
+        }
+        total_bytes += ph->p_memsz;
+        RISCV_info("Loading segment [%08" RV_PRI64 "x, %" RV_PRI64 "d B]",
+                   ph->p_paddr, ph->p_memsz);
+    }
+    loadRanges(ranges);
+    return static_cast<int>(total_bytes);
 }
 
 int ElfLoaderService::loadSections() {
+    std::vector<LoadRangeType> ranges;
     SectionHeaderType *sh;
+    LoadRangeType r;
     uint64_t total_bytes = 0;
 
     for (int i = 0; i < header_->e_shnum; i++) {
@@ -117,15 +289,21 @@ int ElfLoaderService::loadSections() {
             RISCV_info("Loading '%s' section", &sectionNames_[sh->sh_name]);
         }
 
-        if (sh->sh_type == SHT_PROGBITS) {
+        r.addr = sh->sh_addr;
+        r.size = sh->sh_size;
+        if (sh->sh_type == SHT_PROGBITS
+            && sh->sh_offset + sh->sh_size > image_size_) {
+            RISCV_error("Section %d is out of file", i);
+        } else if (sh->sh_type == SHT_PROGBITS) {
             /**
              * @brief   Instructions or other processor's information
              * @details This section holds information defined by the program, 
              *          whose format and meaning are determined solely by the
              *          program.
              */
-            total_bytes += 
-                loadMemory(sh->sh_addr, &image_[sh->sh_offset], sh->sh_size);
+            r.buf = &image_[sh->sh_offset];
+            ranges.push_back(r);
+            total_bytes += r.size;
         } else if (sh->sh_type == SHT_NOBITS) {
             /**
              * @brief   Initialized data
@@ -134,22 +312,51 @@ int ElfLoaderService::loadSections() {
              *          section contains no bytes, the sh_offset member
              *          contains the conceptual file offset.
              */
-             total_bytes += initMemory(sh->sh_addr, sh->sh_size);
-        } else if (sh->sh_type == SHT_SYMTAB || sh->sh_type == SHT_DYNSYM) {
-            processDebugSymbol(sh);
+            r.buf = NULL;
+            ranges.push_back(r);
+            total_bytes += r.size;
         }
     }
+    loadRanges(ranges);
     return static_cast<int>(total_bytes);
 }
 
+void ElfLoaderService::loadRanges(std::vector<LoadRangeType> &ranges) {
+    std::sort(ranges.begin(), ranges.end(), lessAddr);
+    unsigned i = 0;
+    while (i < ranges.size()) {
+        LoadRangeType r = ranges[i++];
+        while (i < ranges.size() && ranges[i].addr == r.addr + r.size
+            && ((!r.buf && !ranges[i].buf)
+                || (r.buf && ranges[i].buf == r.buf + r.size))) {
+            r.size += ranges[i++].size;
+        }
+        if (!deltaLoad_.to_bool()) {
+            if (r.buf) {
+                loadMemory(r.addr, r.buf, r.size);
+            } else {
+                initMemory(r.addr, r.size);
+            }
+        } else if (r.buf) {
+            writeDelta(r.addr, r.buf, r.size);
+        } else {
+            // Pages are compared with one zero chunk reused for the range
+            uint64_t chunk = (VERIFY_CHUNK_BYTES / page_) * page_;
+            uint8_t *zero = new uint8_t[static_cast<unsigned>(chunk)];
+            memset(zero, 0, static_cast<size_t>(chunk));
+            for (uint64_t off = 0; off < r.size; off += chunk) {
+                writeDelta(r.addr + off, zero,
+                           r.size - off < chunk ? r.size - off : chunk);
+            }
+            delete [] zero;
+        }
+    }
+}
+
+/** Section names (.shstrtab) are taken by index from the ELF header. */
 void ElfLoaderService::processStringTable(SectionHeaderType *sh) {
     if (sectionNames_ == NULL) {
-        sectionNames_ = reinterpret_cast<char *>(&image_[sh->sh_offset]);
-        if (strcmp(sectionNames_ + sh->sh_name, ".shstrtab") != 0) {
-            /** This section holds section names. */
-            printf("err: undefined .shstrtab section\n");
-            sectionNames_ = NULL;
-        }
+        RISCV_error("Undefined .shstrtab section", NULL);
     } else if (strcmp(sectionNames_ + sh->sh_name, ".strtab") == 0) {
         /** 
          * This section holds strings, most commonly the strings that
@@ -165,9 +372,20 @@ void ElfLoaderService::processStringTable(SectionHeaderType *sh) {
     }
 }
 
+/**
+ * Defined function, object and untyped symbols are indexed. Names are taken
+ * from the linked string table and interned, so the index stays valid after
+ * the file is unmapped.
+ */
 void ElfLoaderService::processDebugSymbol(SectionHeaderType *sh) {
     uint64_t symbol_off = 0;
     SymbolTableType *st;
+    if (sh->sh_link >= header_->e_shnum) {
+        RISCV_error("Wrong string table of symbols %d", sh->sh_link);
+        return;
+    }
+    const char *names = reinterpret_cast<char *>
+                            (&image_[sh_tbl_[sh->sh_link].sh_offset]);
 
     while (symbol_off < sh->sh_size) {
         st = reinterpret_cast<SymbolTableType *>
@@ -181,37 +399,413 @@ void ElfLoaderService::processDebugSymbol(SectionHeaderType *sh) {
         } else {
             symbol_off += sizeof(SymbolTableType);
         }
-        //debug_symbols.push_back(*st);
+
+        unsigned char type = ELF32_ST_TYPE(st->st_info);
+        unsigned char bind = ELF32_ST_BIND(st->st_info);
+        if (st->st_name == 0 || st->st_shndx == SHN_UNDEF
+            || (type != STT_FUNC && type != STT_OBJECT
+                && type != STT_NOTYPE)) {
+            continue;
+        }
+        SymbolEntryType entry;
+        entry.addr = st->st_value;
+        entry.size = st->st_size;
+        entry.rank = type == STT_FUNC ? 2 : type == STT_OBJECT ? 1 : 0;
+        if (bind == STB_GLOBAL || bind == STB_WEAK) {
+            entry.rank += 4;
+        }
+        SymbolAddrMapType::value_type
+            item(names + st->st_name, std::make_pair(entry.addr, entry.rank));
+        std::pair<SymbolAddrMapType::iterator, bool>
+            res = symbolAddr_.insert(item);
+        if (!res.second && res.first->second.second < entry.rank) {
+            // global definition hides local symbols with the same name
+            res.first->second = item.second;
+        }
+        entry.name = res.first->first.c_str();
+        symbols_.push_back(entry);
     }
 }
 
+/**
+ * With verification chunk k is written in one list with the check request
+ * of chunk k-1 while the results of chunk k-2 are compared. The check is
+ * the target CRC when supported, otherwise the read back data.
+ */
 uint64_t ElfLoaderService::loadMemory(uint64_t addr, 
                                       uint8_t *buf, uint64_t bufsz) {
-    itap_->write(addr, static_cast<int>(bufsz), buf);
-
-    if (verify_ena_.to_bool()) {
-        uint8_t *chk = new uint8_t [static_cast<int>(bufsz) + 8];
-        itap_->read(addr, static_cast<int>(bufsz), chk);
-        for (uint64_t i = 0; i < bufsz; i++) {
-            if (buf[i] != chk[i]) {
-                RISCV_error("[%08" RV_PRI64 "x] verif. error %02x != %02x",
-                            addr + i, buf[i], chk[i]);
+    if (!verify_ena_.to_bool()) {
+        itap_->write(addr, static_cast<int>(bufsz), buf);
+        return bufsz;
+    }
+    uint64_t dsu = crcDsuAddress_.to_uint64();
+    uint64_t chunks = (bufsz + VERIFY_CHUNK_BYTES - 1) / VERIFY_CHUNK_BYTES;
+    uint8_t *chk[2];
+    uint64_t regs[2][2];        // crc_addr, crc_page
+    uint64_t crc[2] = {0, 0};
+    TapRequestType reqs[3];
+    chk[0] = 0;
+    chk[1] = 0;
+    if (!target_crc_) {
+        chk[0] = new uint8_t[2 * VERIFY_CHUNK_BYTES];
+        chk[1] = chk[0] + VERIFY_CHUNK_BYTES;
+    }
+
+    for (uint64_t k = 0; k <= chunks; k++) {
+        int cnt = 0;
+        if (k < chunks) {
+            uint64_t off = k * VERIFY_CHUNK_BYTES;
+            reqs[cnt].addr = addr + off;
+            reqs[cnt].bytes = chunkSize(bufsz, off);
+            reqs[cnt].buf = &buf[off];
+            reqs[cnt++].rw = 1;
+        }
+        if (k > 0) {
+            uint64_t off = (k - 1) * VERIFY_CHUNK_BYTES;
+            int slot = static_cast<int>((k - 1) & 0x1);
+            if (target_crc_) {
+                regs[slot][0] = addr + off;
+                regs[slot][1] = chunkSize(bufsz, off);
+                reqs[cnt].addr = dsu + DSU_CRC_REGS_OFFSET;
+                reqs[cnt].bytes = sizeof(regs[slot]);
+                reqs[cnt].buf = reinterpret_cast<uint8_t *>(regs[slot]);
+                reqs[cnt++].rw = 1;
+                reqs[cnt].addr = dsu + DSU_CRC_TABLE_OFFSET;
+                reqs[cnt].bytes = sizeof(crc[slot]);
+                reqs[cnt].buf = reinterpret_cast<uint8_t *>(&crc[slot]);
+                reqs[cnt++].rw = 0;
+            } else {
+                reqs[cnt].addr = addr + off;
+                reqs[cnt].bytes = chunkSize(bufsz, off);
+                reqs[cnt].buf = chk[slot];
+                reqs[cnt++].rw = 0;
             }
         }
-        delete [] chk;
+        RISCV_event_clear(&tap_done_);
+        itap_->submit(reqs, cnt, static_cast<ITapListener *>(this));
+        if (k > 1) {
+            int slot = static_cast<int>(k & 0x1);
+            compareChunk(addr, buf, bufsz, (k - 2) * VERIFY_CHUNK_BYTES,
+                         chk[slot], crc[slot]);
+        }
+        RISCV_event_wait(&tap_done_);
     }
+    if (chunks) {
+        int slot = static_cast<int>((chunks - 1) & 0x1);
+        compareChunk(addr, buf, bufsz, (chunks - 1) * VERIFY_CHUNK_BYTES,
+                     chk[slot], crc[slot]);
+    }
+    delete [] chk[0];
     return bufsz;
 }
 
+int ElfLoaderService::chunkSize(uint64_t bufsz, uint64_t off) {
+    if (bufsz - off < static_cast<uint64_t>(VERIFY_CHUNK_BYTES)) {
+        return static_cast<int>(bufsz - off);
+    }
+    return VERIFY_CHUNK_BYTES;
+}
+
+void ElfLoaderService::compareChunk(uint64_t addr, uint8_t *buf,
+                                    uint64_t bufsz, uint64_t off,
+                                    uint8_t *chk, uint64_t crc) {
+    int sz = chunkSize(bufsz, off);
+    if (target_crc_) {
+        uint32_t host = RISCV_crc32(&buf[off], sz, 0);
+        if (crc != host) {
+            RISCV_error("[%08" RV_PRI64 "x] verif. error crc %08x != %08x",
+                        addr + off, host, static_cast<uint32_t>(crc));
+        }
+        return;
+    }
+    for (int i = 0; i < sz; i++) {
+        if (buf[off + i] != chk[i]) {
+            RISCV_error("[%08" RV_PRI64 "x] verif. error %02x != %02x",
+                        addr + off + i, buf[off + i], chk[i]);
+        }
+    }
+}
+
+/** Zero range is one fill request, the TAP doesn't transfer zeros. */
 uint64_t ElfLoaderService::initMemory(uint64_t addr, uint64_t bufsz) {
-    uint32_t zero = 0;
-    uint64_t cnt = 0;
-    while (cnt < bufsz) {
-        itap_->write(addr, 4, reinterpret_cast<uint8_t *>(&zero));
-        addr += 4;
-        cnt += 4;
+    return itap_->fill(addr, static_cast<int>(bufsz), 0);
+}
+
+/**
+ * DSU of the simulator computes page CRC by request. Registers are
+ * written and read back to make sure the target implements them. The
+ * region is undefined in hardware, so it isn't touched without simulation.
+ */
+bool ElfLoaderService::probeTargetCrc() {
+    uint64_t dsu = crcDsuAddress_.to_uint64();
+    const AttributeType *glb = RISCV_get_global_settings();
+    if (dsu == 0 || !(*glb)["SimEnable"].to_bool()) {
+        return false;
     }
-    return bufsz;
+    uint64_t wr[2] = {dsu, page_};     // crc_addr, crc_page
+    uint64_t rd[2] = {0, 0};
+    TapRequestType reqs[2];
+    reqs[0].addr = dsu + DSU_CRC_REGS_OFFSET;
+    reqs[0].bytes = sizeof(wr);
+    reqs[0].buf = reinterpret_cast<uint8_t *>(wr);
+    reqs[0].rw = 1;
+    reqs[1].addr = dsu + DSU_CRC_REGS_OFFSET;
+    reqs[1].bytes = sizeof(rd);
+    reqs[1].buf = reinterpret_cast<uint8_t *>(rd);
+    reqs[1].rw = 0;
+    tapTransfer(reqs, 2);
+    if (rd[0] != wr[0] || rd[1] != wr[1]) {
+        RISCV_info("Target CRC isn't supported", NULL);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Full pages are checked by batches, consecutive changed pages are written
+ * with one write. Partial tail of the range is always written.
+ */
+void ElfLoaderService::writeDelta(uint64_t addr, uint8_t *buf,
+                                  uint64_t bufsz) {
+    uint32_t crc[DELTA_BATCH_PAGES];
+    bool need[DELTA_BATCH_PAGES];
+    uint64_t off = 0;
+
+    while (off + page_ <= bufsz) {
+        unsigned cnt = static_cast<unsigned>((bufsz - off) / page_);
+        if (cnt > DELTA_BATCH_PAGES) {
+            cnt = DELTA_BATCH_PAGES;
+        }
+        for (unsigned i = 0; i < cnt; i++) {
+            crc[i] = RISCV_crc32(&buf[off + i * page_], page_, 0);
+        }
+        checkPages(addr + off, cnt, crc, need);
+
+        unsigned i = 0;
+        while (i < cnt) {
+            if (!need[i]) {
+                i++;
+                continue;
+            }
+            unsigned start = i;
+            while (i < cnt && need[i]) {
+                i++;
+            }
+            loadMemory(addr + off + start * page_,
+                       &buf[off + start * page_], (i - start) * page_);
+            pages_written_ += i - start;
+        }
+        for (i = 0; i < cnt; i++) {
+            pageCrc_[addr + off + i * page_] = crc[i];
+        }
+        pages_total_ += cnt;
+        off += cnt * page_;
+    }
+    if (off < bufsz) {
+        loadMemory(addr + off, &buf[off], bufsz - off);
+    }
+}
+
+void ElfLoaderService::checkPages(uint64_t addr, unsigned cnt,
+                                  const uint32_t *crc, bool *need) {
+    if (target_crc_) {
+        uint64_t dsu = crcDsuAddress_.to_uint64();
+        uint64_t regs[2] = {addr, page_};
+        uint64_t target[DELTA_BATCH_PAGES];
+        TapRequestType reqs[2];
+        reqs[0].addr = dsu + DSU_CRC_REGS_OFFSET;
+        reqs[0].bytes = sizeof(regs);
+        reqs[0].buf = reinterpret_cast<uint8_t *>(regs);
+        reqs[0].rw = 1;
+        reqs[1].addr = dsu + DSU_CRC_TABLE_OFFSET;
+        reqs[1].bytes = cnt * sizeof(uint64_t);
+        reqs[1].buf = reinterpret_cast<uint8_t *>(target);
+        reqs[1].rw = 0;
+        tapTransfer(reqs, 2);
+        for (unsigned i = 0; i < cnt; i++) {
+            need[i] = target[i] != crc[i];
+        }
+    } else if (trustCache_.to_bool()) {
+        // Target memory is assumed unchanged since the last loading
+        for (unsigned i = 0; i < cnt; i++) {
+            std::map<uint64_t, uint32_t>::iterator it =
+                pageCrc_.find(addr + i * page_);
+            need[i] = it == pageCrc_.end() || it->second != crc[i];
+        }
+    } else {
+        uint8_t *chk = new uint8_t[VERIFY_CHUNK_BYTES];
+        unsigned per_read = static_cast<unsigned>(VERIFY_CHUNK_BYTES / page_);
+        for (unsigned i = 0; i < cnt; i += per_read) {
+            unsigned n = cnt - i < per_read ? cnt - i : per_read;
+            itap_->read(addr + i * page_, static_cast<int>(n * page_), chk);
+            for (unsigned k = 0; k < n; k++) {
+                need[i + k] =
+                    RISCV_crc32(&chk[k * page_], page_, 0) != crc[i + k];
+            }
+        }
+        delete [] chk;
+    }
+}
+
+/**
+ * Line table is decoded once per build-id. Files without build-id are
+ * decoded on each loading.
+ */
+void ElfLoaderService::processDebugLines() {
+    DwarfSectionsType sec;
+    std::string build_id;
+    memset(&sec, 0, sizeof(sec));
+    lines_ = NULL;
+    if (!header_->e_shoff || !sectionNames_) {
+        return;
+    }
+    for (int i = 0; i < header_->e_shnum; i++) {
+        SectionHeaderType *sh = &sh_tbl_[i];
+        const char *name = sectionNames_ + sh->sh_name;
+        if (sh->sh_offset + sh->sh_size > image_size_) {
+            continue;
+        }
+        if (sh->sh_type == SHT_NOTE) {
+            readBuildId(sh, &build_id);
+        } else if (sh->sh_flags & SHF_COMPRESSED) {
+            continue;
+        } else if (strcmp(name, ".debug_line") == 0) {
+            sec.line = &image_[sh->sh_offset];
+            sec.line_size = sh->sh_size;
+        } else if (strcmp(name, ".debug_line_str") == 0) {
+            sec.line_str = &image_[sh->sh_offset];
+            sec.line_str_size = sh->sh_size;
+        } else if (strcmp(name, ".debug_str") == 0) {
+            sec.str = &image_[sh->sh_offset];
+            sec.str_size = sh->sh_size;
+        }
+    }
+    if (sec.line_size == 0) {
+        return;
+    }
+
+    std::map<std::string, DwarfLineTable *>::iterator it =
+        lineCache_.find(build_id);
+    if (it != lineCache_.end()) {
+        lineCacheLru_.remove(build_id);
+        if (build_id.size()) {
+            lineCacheLru_.push_front(build_id);
+            lines_ = it->second;
+            RISCV_info("Line table of build-id %s is cached",
+                        build_id.c_str());
+            return;
+        }
+        delete it->second;
+        lineCache_.erase(it);
+    }
+    if (lineCache_.size() >= LINE_CACHE_MAX) {
+        it = lineCache_.find(lineCacheLru_.back());
+        delete it->second;
+        lineCache_.erase(it);
+        lineCacheLru_.pop_back();
+    }
+    DwarfLineTable *tbl = new DwarfLineTable;
+    if (!tbl->parse(&sec)) {
+        delete tbl;
+        return;
+    }
+    lineCache_[build_id] = tbl;
+    lineCacheLru_.push_front(build_id);
+    lines_ = tbl;
+    RISCV_info("Line table: %d rows, %d files", tbl->getRowCount(),
+                tbl->getFileCount());
+}
+
+void ElfLoaderService::readBuildId(SectionHeaderType *sh,
+                                   std::string *build_id) {
+    uint64_t off = 0;
+    while (off + sizeof(NoteHeaderType) <= sh->sh_size) {
+        NoteHeaderType *n = reinterpret_cast<NoteHeaderType *>
+                                (&image_[sh->sh_offset + off]);
+        uint64_t name_off = off + sizeof(NoteHeaderType);
+        uint64_t desc_off = name_off + ((n->n_namesz + 3) & ~3ull);
+        off = desc_off + ((n->n_descsz + 3) & ~3ull);
+        if (off > sh->sh_size) {
+            break;
+        }
+        const char *name = reinterpret_cast<char *>
+                                (&image_[sh->sh_offset + name_off]);
+        if (n->n_type != NT_GNU_BUILD_ID || n->n_namesz != 4
+            || memcmp(name, "GNU", 4) != 0) {
+            continue;
+        }
+        char hex[3];
+        build_id->clear();
+        for (unsigned i = 0; i < n->n_descsz; i++) {
+            RISCV_sprintf(hex, sizeof(hex), "%02x",
+                          image_[sh->sh_offset + desc_off + i]);
+            build_id->append(hex);
+        }
+        return;
+    }
+}
+
+/**
+ * The last of the symbols with the nearest address not above addr is taken.
+ * Sized symbols match only addresses inside them.
+ */
+const char *ElfLoaderService::findSymbol(uint64_t addr, uint64_t *offset) {
+    const char *ret = NULL;
+    RISCV_mutex_lock(&mutexSymbols_);
+    std::vector<SymbolEntryType>::iterator it =
+        std::upper_bound(symbols_.begin(), symbols_.end(), addr,
+                         lessSymbolAddr);
+    if (it != symbols_.begin()) {
+        --it;
+        if (it->size == 0 || addr < it->addr + it->size) {
+            ret = it->name;
+            if (offset) {
+                *offset = addr - it->addr;
+            }
+        }
+    }
+    RISCV_mutex_unlock(&mutexSymbols_);
+    return ret;
+}
+
+bool ElfLoaderService::findAddress(const char *name, uint64_t *addr) {
+    bool ret = false;
+    RISCV_mutex_lock(&mutexSymbols_);
+    SymbolAddrMapType::iterator it = symbolAddr_.find(name);
+    if (it != symbolAddr_.end()) {
+        *addr = it->second.first;
+        ret = true;
+    }
+    RISCV_mutex_unlock(&mutexSymbols_);
+    return ret;
+}
+
+unsigned ElfLoaderService::getSymbolCount() {
+    RISCV_mutex_lock(&mutexSymbols_);
+    unsigned ret = static_cast<unsigned>(symbols_.size());
+    RISCV_mutex_unlock(&mutexSymbols_);
+    return ret;
+}
+
+const char *ElfLoaderService::findLine(uint64_t addr, int *line) {
+    const char *ret = NULL;
+    RISCV_mutex_lock(&mutexSymbols_);
+    if (lines_) {
+        ret = lines_->findLine(addr, line);
+    }
+    RISCV_mutex_unlock(&mutexSymbols_);
+    return ret;
+}
+
+/** Submit scatter-gather request and wait its completion. */
+void ElfLoaderService::tapTransfer(TapRequestType *reqs, int cnt) {
+    RISCV_event_clear(&tap_done_);
+    itap_->submit(reqs, cnt, static_cast<ITapListener *>(this));
+    RISCV_event_wait(&tap_done_);
+}
+
+void ElfLoaderService::tapCompleted(TapRequestType *reqs, int cnt) {
+    RISCV_event_set(&tap_done_);
 }
 
 }  // namespace debugger
@@ -12,12 +12,40 @@
 #include "iservice.h"
 #include "coreservices/itap.h"
 #include "coreservices/ielfloader.h"
+#include "coreservices/isymtable.h"
 #include "elf_types.h"
+#include "dwarfline.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <list>
+#include <unordered_map>
 
 namespace debugger {
 
+/**
+ * @brief Loader of the ELF-file into target memory via ITap.
+ * @details File is mapped into memory. When program headers exist, PT_LOAD
+ *          segments are loaded with adjacent segments merged into one
+ *          write and zero-initialized tails (.bss) filled by one write per
+ *          continuous range. Files without program headers are loaded by
+ *          allocated sections.
+ *          With 'DeltaLoad' only pages that differ from the image are
+ *          written. Target pages are checked by CRC-32 computed by the
+ *          simulated DSU ('CrcDsuAddress', used only when 'SimEnable'
+ *          is set), or by hashes of the last loaded image ('TrustCache'),
+ *          or by hashing read back memory. It's off by default since
+ *          reading back a board without the DSU CRC makes the first load
+ *          about twice as long.
+ *          Symbols of the loaded file are kept sorted by address with
+ *          interned names for the ISymbolTable lookups. DWARF line tables
+ *          are cached by GNU build-id, reloading of the same build
+ *          doesn't decode .debug_line again.
+ */
 class ElfLoaderService : public IService,
-                         public IElfLoader {
+                         public IElfLoader,
+                         public ISymbolTable,
+                         public ITapListener {
 public:
     explicit ElfLoaderService(const char *name);
     virtual ~ElfLoaderService();
@@ -28,25 +56,115 @@ public:
     /** IElfLoader interface */
     virtual int loadFile(const char *filename);
 
+    /** ISymbolTable interface */
+    virtual const char *findSymbol(uint64_t addr, uint64_t *offset);
+    virtual bool findAddress(const char *name, uint64_t *addr);
+    virtual unsigned getSymbolCount();
+    virtual const char *findLine(uint64_t addr, int *line);
+
+    /** ITapListener */
+    virtual void tapCompleted(TapRequestType *reqs, int cnt);
+
 private:
-    void readElfHeader();
+    /** Continuous memory range, buf = NULL means zero fill. */
+    struct LoadRangeType {
+        uint64_t addr;
+        uint8_t *buf;
+        uint64_t size;
+    };
+
+    static bool lessAddr(const LoadRangeType &a, const LoadRangeType &b) {
+        return a.addr < b.addr;
+    }
+
+    /** Symbol index entry, name points to the key of symbolAddr_. */
+    struct SymbolEntryType {
+        uint64_t addr;
+        uint64_t size;
+        const char *name;
+        int rank;       // preferred among symbols with the same address
+    };
+
+    static bool lessSymbol(const SymbolEntryType &a,
+                           const SymbolEntryType &b) {
+        if (a.addr != b.addr) {
+            return a.addr < b.addr;
+        }
+        return a.rank < b.rank;
+    }
+    static bool lessSymbolAddr(uint64_t addr, const SymbolEntryType &b) {
+        return addr < b.addr;
+    }
+
+    /** Symbol name to its address and rank. */
+    typedef std::unordered_map<std::string,
+                               std::pair<uint64_t, int> > SymbolAddrMapType;
+    bool mapFile(const char *filename);
+    void unmapFile();
+    bool readElfHeader();
+    int loadSegments();
     int loadSections();
+    void loadRanges(std::vector<LoadRangeType> &ranges);
     void processStringTable(SectionHeaderType *sh);
     void processDebugSymbol(SectionHeaderType *sh);
+    void processDebugLines();
+    void readBuildId(SectionHeaderType *sh, std::string *build_id);
 
     uint64_t loadMemory(uint64_t addr, uint8_t *buf, uint64_t bufsz);
     uint64_t initMemory(uint64_t addr, uint64_t bufsz);
 
+    bool probeTargetCrc();
+    void writeDelta(uint64_t addr, uint8_t *buf, uint64_t bufsz);
+    void checkPages(uint64_t addr, unsigned cnt, const uint32_t *crc,
+                    bool *need);
+    void tapTransfer(TapRequestType *reqs, int cnt);
+    int chunkSize(uint64_t bufsz, uint64_t off);
+    void compareChunk(uint64_t addr, uint8_t *buf, uint64_t bufsz,
+                      uint64_t off, uint8_t *chk, uint64_t crc);
+
 private:
+    /** Verification reads target memory by chunks of this size. */
+    static const int VERIFY_CHUNK_BYTES = 64 * 1024;
+    /** Pages checked with one request, the same as DSU CRC table size. */
+    static const unsigned DELTA_BATCH_PAGES = 512;
+    /** DSU control region: CRC address/page registers and CRC table. */
+    static const uint64_t DSU_CRC_REGS_OFFSET = 0x590;
+    static const uint64_t DSU_CRC_TABLE_OFFSET = 0x1000;
+    /** Line tables of different builds kept in memory. */
+    static const unsigned LINE_CACHE_MAX = 8;
+
     ITap *itap_;
     AttributeType tap_;
-    AttributeType verify_ena_;  // read and compare memory after write
+    AttributeType verify_ena_;  // check memory while writing next chunk
+    AttributeType deltaLoad_;
+    AttributeType pageSize_;
+    AttributeType crcDsuAddress_;
+    AttributeType trustCache_;
 
     uint8_t *image_;
+    uint64_t image_size_;
+    bool mapped_;           // image_ is mmap'ed, otherwise allocated
     ElfHeaderType *header_;
     SectionHeaderType *sh_tbl_;
     char *sectionNames_;
     char *symbolNames_;
+
+    // Symbol index:
+    std::vector<SymbolEntryType> symbols_;
+    SymbolAddrMapType symbolAddr_;
+    mutex_def mutexSymbols_;
+    // Line tables by build-id, empty id is the file without build-id:
+    std::map<std::string, DwarfLineTable *> lineCache_;
+    std::list<std::string> lineCacheLru_;   // most recently used first
+    DwarfLineTable *lines_;
+
+    // Delta loading:
+    std::map<uint64_t, uint32_t> pageCrc_;  // last loaded page hashes
+    event_def tap_done_;
+    bool target_crc_;
+    uint64_t page_;
+    uint64_t pages_total_;
+    uint64_t pages_written_;
 };
 
 DECLARE_CLASS(ElfLoaderService)
@@ -0,0 +1,125 @@
+/**
+ * @file
+ * @copyright  Copyright 2016 GNSS Sensor Ltd. All right reserved.
+ * @author     Sergey Khabarov - sergeykhbr@gmail.com
+ * @brief      I/O events demultiplexer (epoll based reactor).
+ */
+
+#include "api_core.h"
+#include "reactor.h"
+#if defined(_WIN32) || defined(__CYGWIN__)
+#else
+#include <sys/epoll.h>
+#include <errno.h>
+#endif
+
+namespace debugger {
+
+/** Class registration in the Core */
+REGISTER_CLASS(ReactorService)
+
+ReactorService::ReactorService(const char *name) : IService(name) {
+    registerInterface(static_cast<IThread *>(this));
+    registerThreadAttributes(this);
+    registerInterface(static_cast<IReactor *>(this));
+    RISCV_mutex_init(&mutex_);
+#if defined(_WIN32) || defined(__CYGWIN__)
+    epfd_ = -1;
+#else
+    epfd_ = epoll_create1(EPOLL_CLOEXEC);
+#endif
+}
+
+ReactorService::~ReactorService() {
+#if defined(_WIN32) || defined(__CYGWIN__)
+#else
+    if (epfd_ >= 0) {
+        close(epfd_);
+    }
+#endif
+    RISCV_mutex_destroy(&mutex_);
+}
+
+void ReactorService::postinitService() {
+    if (epfd_ < 0) {
+        RISCV_info("Reactor isn't supported, services use polling", NULL);
+        return;
+    }
+    if (!run()) {
+        RISCV_error("Can't create thread.", NULL);
+    }
+}
+
+void ReactorService::predeleteService() {
+    stop();
+}
+
+int ReactorService::registerReadHandler(socket_def fd,
+                                        IReactorListener *ilistener) {
+#if defined(_WIN32) || defined(__CYGWIN__)
+    return -1;
+#else
+    if (epfd_ < 0) {
+        return -1;
+    }
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.fd = fd;
+
+    RISCV_mutex_lock(&mutex_);
+    listeners_[fd] = ilistener;
+    if (epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        // Regular files or /dev/null as stdin aren't pollable
+        listeners_.erase(fd);
+        RISCV_mutex_unlock(&mutex_);
+        RISCV_debug("Descriptor %d cannot be polled, errno=%d", fd, errno);
+        return -1;
+    }
+    RISCV_mutex_unlock(&mutex_);
+    return 0;
+#endif
+}
+
+void ReactorService::unregisterReadHandler(socket_def fd) {
+#if defined(_WIN32) || defined(__CYGWIN__)
+#else
+    RISCV_mutex_lock(&mutex_);
+    if (listeners_.erase(fd)) {
+        epoll_ctl(epfd_, EPOLL_CTL_DEL, fd, NULL);
+    }
+    RISCV_mutex_unlock(&mutex_);
+#endif
+}
+
+void ReactorService::busyLoop() {
+#if defined(_WIN32) || defined(__CYGWIN__)
+#else
+    struct epoll_event events[REACTOR_EVENTS_MAX];
+    while (isEnabled()) {
+        int n = epoll_wait(epfd_, events, REACTOR_EVENTS_MAX,
+                           REACTOR_POLL_MS);
+        for (int i = 0; i < n; i++) {
+            dispatch(events[i].data.fd);
+        }
+    }
+#endif
+    loopEnable_ = false;
+    threadInit_.Handle = 0;
+}
+
+/**
+ * Listener is called under lock so it cannot be called after
+ * unregisterReadHandler() returned.
+ */
+void ReactorService::dispatch(socket_def fd) {
+    RISCV_mutex_lock(&mutex_);
+    std::map<socket_def, IReactorListener *>::iterator it =
+        listeners_.find(fd);
+    if (it != listeners_.end()) {
+        it->second->readyRead(fd);
+    }
+    RISCV_mutex_unlock(&mutex_);
+}
+
+}  // namespace debugger
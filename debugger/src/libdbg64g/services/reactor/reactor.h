@@ -0,0 +1,64 @@
+/**
+ * @file
+ * @copyright  Copyright 2016 GNSS Sensor Ltd. All right reserved.
+ * @author     Sergey Khabarov - sergeykhbr@gmail.com
+ * @brief      I/O events demultiplexer (epoll based reactor).
+ */
+
+#ifndef __DEBUGGER_REACTOR_H__
+#define __DEBUGGER_REACTOR_H__
+
+#include "iclass.h"
+#include "iservice.h"
+#include "coreservices/ithread.h"
+#include "coreservices/ireactor.h"
+#include <map>
+
+namespace debugger {
+
+/**
+ * @brief Single thread waiting input on all registered descriptors.
+ * @details Services (UDP sockets, console input) register descriptors
+ *          instead of polling them, so that their threads sleep on an
+ *          event and wake up immediately when data arrives. Only Linux
+ *          epoll is supported, on other platforms registration fails and
+ *          services use their own polling.
+ */
+class ReactorService : public IService,
+                       public IThread,
+                       public IReactor {
+public:
+    explicit ReactorService(const char *name);
+    virtual ~ReactorService();
+
+    /** IService interface */
+    virtual void postinitService();
+    virtual void predeleteService();
+
+    /** IReactor interface */
+    virtual int registerReadHandler(socket_def fd,
+                                    IReactorListener *ilistener);
+    virtual void unregisterReadHandler(socket_def fd);
+
+protected:
+    /** IThread interface */
+    virtual void busyLoop();
+
+private:
+    void dispatch(socket_def fd);
+
+private:
+    /** Period to check thread stop request. */
+    static const int REACTOR_POLL_MS = 100;
+    static const int REACTOR_EVENTS_MAX = 16;
+
+    int epfd_;
+    mutex_def mutex_;
+    std::map<socket_def, IReactorListener *> listeners_;
+};
+
+DECLARE_CLASS(ReactorService)
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_REACTOR_H__
@@ -17,8 +17,20 @@ EdclService::EdclService(const char *name) : IService(name) {
     registerInterface(static_cast<ITap *>(this));
     registerAttribute("Transport", &transport_);
     registerAttribute("seq_cnt", &seq_cnt_);
+    registerAttribute("PayloadMax", &payloadMax_);
+    registerAttribute("Window", &window_);
     seq_cnt_.make_uint64(0);
+    payloadMax_.make_int64(EDCL_PAYLOAD_DEFAULT_BYTES);
+    window_.make_int64(EDCL_WINDOW_DEFAULT);
     itransport_ = 0;
+    for (int i = 0; i < EDCL_WINDOW_MAX; i++) {
+        tx_items_[i].buf = tx_buf_[i];
+        tx_items_[i].size = 0;
+        tx_items_[i].len = 0;
+        rx_items_[i].buf = rx_buf_[i];
+        rx_items_[i].size = EDCL_DATAGRAM_MAX_BYTES;
+        rx_items_[i].len = 0;
+    }
 }
 
 void EdclService::postinitService() {
@@ -36,144 +48,213 @@ void EdclService::postinitService() {
 }
 
 int EdclService::read(uint64_t addr, int bytes, uint8_t *obuf) {
-    int off;
-    UdpEdclCommonType req = {0};
+    return transfer(0, addr, bytes, obuf);
+}
+
+int EdclService::write(uint64_t addr, int bytes, uint8_t *ibuf) {
+    return transfer(1, addr, bytes, ibuf);
+}
+
+/**
+ * @brief Pipelined block transfer.
+ * @details Transfer is splitted on 'PayloadMax' chunks and up to 'Window'
+ *          requests are sent without waiting responses. Board processes
+ *          requests in order: ACK echoes seqidx of the executed request,
+ *          NAK returns the seqidx expected by the board and all requests
+ *          sent after the rejected one are NAKed too. So on the first NAK
+ *          sending is suspended until all in-flight responses are drained,
+ *          then only chunks without ACK are re-sent starting from the
+ *          expected seqidx. Timeout restarts all unacknowledged chunks.
+ *          New requests of the window are sent and available responses
+ *          are received with one batch call of the transport.
+ */
+int EdclService::transfer(int write, uint64_t addr, int bytes, uint8_t *buf) {
     UdpEdclCommonType rsp;
+    const char *NAK[2] = {"ACK", "NAK"};
 
     if (!itransport_) {
         RISCV_error("UDP transport not defined, addr=%x", addr);
         return 0;
     }
+    if (bytes <= 0) {
+        return 0;
+    }
 
-    int rd_bytes = 0;
-    while (rd_bytes < bytes && rd_bytes != -1) {
-        req.control.request.seqidx = 
-                    static_cast<uint32_t>(seq_cnt_.to_uint64());
-        req.control.request.write = 0;
-        req.address = static_cast<uint32_t>(addr + rd_bytes);
-        if ((bytes - rd_bytes) > EDCL_PAYLOAD_MAX_BYTES) {
-            req.control.request.len = 
-                    static_cast<uint32_t>(EDCL_PAYLOAD_MAX_BYTES);
-        } else {
-            req.control.request.len = static_cast<uint32_t>(bytes - rd_bytes);
-        }
+    int payload = static_cast<int>(payloadMax_.to_int64()) & ~0x3;
+    if (payload <= 0 || payload > EDCL_PAYLOAD_MAX_BYTES) {
+        payload = EDCL_PAYLOAD_DEFAULT_BYTES;
+    }
+    int window = static_cast<int>(window_.to_int64());
+    if (window <= 0) {
+        window = 1;
+    } else if (window > EDCL_WINDOW_MAX) {
+        window = EDCL_WINDOW_MAX;
+    }
 
-        off = write16(tx_buf_, 0, req.offset);
-        off = write32(tx_buf_, off, req.control.word);
-        off = write32(tx_buf_, off, req.address);
+    int chunks = (bytes + payload - 1) / payload;
+    uint8_t *done = new uint8_t[chunks];
+    memset(done, 0, chunks);
+    int done_cnt = 0;
+    int next = 0;           // next chunk to send
+    int head = 0;           // first in-flight request
+    int count = 0;          // number of in-flight requests
+    int retry = 0;
+    bool recovering = false;
+    uint32_t seq = static_cast<uint32_t>(seq_cnt_.to_uint64());
+    int ret = bytes;
 
-        off = itransport_->sendData(tx_buf_, off);
-        if (off == -1) {
+    while (done_cnt < chunks) {
+        // Fill window and send new requests with one batch:
+        int txcnt = 0;
+        while (!recovering && count < window && next < chunks) {
+            if (done[next]) {
+                next++;
+                continue;
+            }
+            int off = next * payload;
+            int len = (bytes - off) > payload ? payload : (bytes - off);
+            tx_items_[txcnt].size = formatRequest(tx_buf_[txcnt], write,
+                                                  addr + off, len,
+                                                  &buf[off], seq);
+            txcnt++;
+            int idx = (head + count) % EDCL_WINDOW_MAX;
+            inflight_chunk_[idx] = next;
+            inflight_seq_[idx] = seq & EDCL_SEQIDX_MASK;
+            count++;
+            seq++;
+            next++;
+        }
+        if (txcnt && itransport_->sendDataBatch(tx_items_, txcnt) != txcnt) {
             RISCV_error("Data sending error", NULL);
-            rd_bytes = -1;
+            ret = -1;
             break;
         }
 
-        off = itransport_->readData(rx_buf_, sizeof(rx_buf_));
-        if (off == -1) {
+        int rxcnt = itransport_->readDataBatch(rx_items_,
+                                               count > 0 ? count : 1);
+        if (rxcnt == -1) {
             RISCV_error("Data receiving error", NULL);
-            rd_bytes = -1;
-            break;
-        } 
-        if (off == 0) {
-            RISCV_error("No response. Break read transaction.", NULL);
-            rd_bytes = -1;
+            ret = -1;
             break;
         }
-
-        rsp.control.word = read32(&rx_buf_[2]);
-
-        const char *NAK[2] = {"ACK", "NAK"};
-        RISCV_debug("EDCL read: %s[%d], len = %d", 
-                    NAK[rsp.control.response.nak],
-                    rsp.control.response.seqidx,
-                    rsp.control.response.len);
-
-        // Retry with new sequence counter.
-        if (rsp.control.response.nak) {
-            RISCV_info("Sequence counter detected %d. Re-sending transaction.",
-                         rsp.control.response.seqidx);
-            seq_cnt_.make_uint64(rsp.control.response.seqidx);
+        if (rxcnt == 0) {
+            if (++retry > EDCL_RETRY_MAX) {
+                RISCV_error("No response. Break %s transaction.",
+                            write ? "write" : "read");
+                ret = -1;
+                break;
+            }
+            // Forget lost requests and re-send all chunks without ACK
+            RISCV_info("Response timeout. Re-sending from seqidx %d",
+                        seq & EDCL_SEQIDX_MASK);
+            count = 0;
+            next = 0;
+            recovering = false;
             continue;
         }
+        for (int k = 0; k < rxcnt; k++) {
+            uint8_t *rxbuf = rx_buf_[k];
+            if (rx_items_[k].len < EDCL_HEADER_BYTES) {
+                // Runt datagram: request stays unacknowledged
+                retry++;
+                continue;
+            }
 
-        memcpy(&obuf[rd_bytes], &rx_buf_[10], rsp.control.response.len);
-        rd_bytes += rsp.control.response.len;
-        seq_cnt_.make_uint64(seq_cnt_.to_uint64() + 1);
-    }
-    return rd_bytes;
-}
-
-int EdclService::write(uint64_t addr, int bytes, uint8_t *ibuf) {
-    int off;
-    UdpEdclCommonType req = {0};
-    UdpEdclCommonType rsp;
-
-    if (!itransport_) {
-        RISCV_error("UDP transport not defined, addr=%x", addr);
-        return 0;
-    }
+            rsp.control.word = read32(&rxbuf[2]);
+            RISCV_debug("EDCL %s: %s[%d], len = %d",
+                        write ? "write" : "read",
+                        NAK[rsp.control.response.nak],
+                        rsp.control.response.seqidx,
+                        rsp.control.response.len);
 
-    int wr_bytes = 0;
-    while (wr_bytes < bytes && wr_bytes != -1) {
-        req.control.request.seqidx = 
-                    static_cast<uint32_t>(seq_cnt_.to_uint64());
-        req.control.request.write = 1;
-        req.address = static_cast<uint32_t>(addr + wr_bytes);
-        if ((bytes - wr_bytes) > EDCL_PAYLOAD_MAX_BYTES) {
-            req.control.request.len = 
-                    static_cast<uint32_t>(EDCL_PAYLOAD_MAX_BYTES);
-        } else {
-            req.control.request.len = static_cast<uint32_t>(bytes - wr_bytes);
-        }
-
-        off = write16(tx_buf_, 0, req.offset);
-        off = write32(tx_buf_, off, req.control.word);
-        off = write32(tx_buf_, off, req.address);
-        memcpy(&tx_buf_[off], &ibuf[wr_bytes], req.control.request.len);
+            if (rsp.control.response.nak) {
+                // Retry with new sequence counter.
+                if (!recovering) {
+                    RISCV_info("Sequence counter detected %d. "
+                               "Re-sending transaction.",
+                               rsp.control.response.seqidx);
+                }
+                seq = rsp.control.response.seqidx;
+                recovering = true;
+                if (count) {
+                    head = (head + 1) % EDCL_WINDOW_MAX;
+                    count--;
+                }
+            } else {
+                // Find request by seqidx, skip requests with lost responses
+                int n = 0;
+                while (n < count
+                    && inflight_seq_[(head + n) % EDCL_WINDOW_MAX]
+                        != rsp.control.response.seqidx) {
+                    n++;
+                }
+                if (n == count) {
+                    // Response of the request from timed out window
+                    continue;
+                }
+                head = (head + n) % EDCL_WINDOW_MAX;
+                count -= n;
 
+                int chunk = inflight_chunk_[head];
+                head = (head + 1) % EDCL_WINDOW_MAX;
+                count--;
+                int off = chunk * payload;
+                int len = (bytes - off) > payload ? payload : (bytes - off);
+                if (!write
+                    && (static_cast<int>(rsp.control.response.len) != len
+                    || rx_items_[k].len < EDCL_HEADER_BYTES + len)) {
+                    // Truncated data, chunk is re-sent as not acknowledged
+                    RISCV_info("Wrong response length %d of seqidx %d",
+                               rx_items_[k].len,
+                               rsp.control.response.seqidx);
+                    retry++;
+                } else if (!done[chunk]) {
+                    if (!write) {
+                        memcpy(&buf[off], &rxbuf[EDCL_HEADER_BYTES], len);
+                    }
+                    done[chunk] = 1;
+                    done_cnt++;
+                    retry = 0;
+                }
+            }
 
-        off = itransport_->sendData(tx_buf_, off + req.control.request.len);
-        if (off == -1) {
-            RISCV_error("Data sending error", NULL);
-            wr_bytes = -1;
-            break;
+            if (recovering && count == 0) {
+                recovering = false;
+                next = 0;
+            } else if (!recovering && next == chunks && count == 0) {
+                // Skipped requests with lost responses
+                next = 0;
+            }
         }
-
-        off = itransport_->readData(rx_buf_, sizeof(rx_buf_));
-        if (off == -1) {
-            RISCV_error("Data receiving error", NULL);
-            wr_bytes = -1;
-            break;
-        } 
-        if (off == 0) {
-            RISCV_error("No response. Break write transaction.", NULL);
-            wr_bytes = -1;
+        if (retry > EDCL_RETRY_MAX) {
+            RISCV_error("Wrong responses. Break %s transaction.",
+                        write ? "write" : "read");
+            ret = -1;
             break;
         }
+    }
+    seq_cnt_.make_uint64(seq & EDCL_SEQIDX_MASK);
+    delete [] done;
+    return ret;
+}
 
-        rsp.control.word = read32(&rx_buf_[2]);
-
-        // Warning:
-        //   response length = 0;
-        const char *NAK[2] = {"ACK", "NAK"};
-        RISCV_debug("EDCL write: %s[%d], len = %d", 
-                    NAK[rsp.control.response.nak],
-                    rsp.control.response.seqidx,
-                    req.control.request.len);
-
-        // Retry with new sequence counter.
-        if (rsp.control.response.nak) {
-            RISCV_info("Sequence counter detected %d. Re-sending transaction.",
-                         rsp.control.response.seqidx);
-            seq_cnt_.make_uint64(rsp.control.response.seqidx);
-            continue;
-        }
+int EdclService::formatRequest(uint8_t *obuf, int write, uint64_t addr,
+                               int len, uint8_t *buf, uint32_t seqidx) {
+    UdpEdclCommonType req = {0};
+    int off;
+    req.control.request.seqidx = seqidx & EDCL_SEQIDX_MASK;
+    req.control.request.write = write;
+    req.control.request.len = static_cast<uint32_t>(len);
+    req.address = static_cast<uint32_t>(addr);
 
-        wr_bytes += req.control.request.len;
-        seq_cnt_.make_uint64(seq_cnt_.to_uint64() + 1);
+    off = write16(obuf, 0, req.offset);
+    off = write32(obuf, off, req.control.word);
+    off = write32(obuf, off, req.address);
+    if (write) {
+        memcpy(&obuf[off], buf, len);
+        off += len;
     }
-    return wr_bytes;
+    return off;
 }
 
 int EdclService::write16(uint8_t *buf, int off, uint16_t v) {
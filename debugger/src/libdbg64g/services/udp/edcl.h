@@ -29,21 +29,47 @@ public:
     virtual int write(uint64_t addr, int bytes, uint8_t *ibuf);
 
 private:
+    int transfer(int write, uint64_t addr, int bytes, uint8_t *buf);
+    int formatRequest(uint8_t *obuf, int write, uint64_t addr, int len,
+                      uint8_t *buf, uint32_t seqidx);
     int write16(uint8_t *buf, int off, uint16_t v);
     int write32(uint8_t *buf, int off, uint32_t v);
     uint32_t read32(uint8_t *buf);
 
 private:
-    /** This is limitation of the MAC fifo. Protocol allows increase the
-     * following value up to 242 words. */
-    static const int EDCL_PAYLOAD_MAX_WORDS32 = 8;
-    static const int EDCL_PAYLOAD_MAX_BYTES  = 4*EDCL_PAYLOAD_MAX_WORDS32;
+    /** Default is the limitation of the MAC fifo. Protocol allows increase
+     * the payload up to 242 words (attribute 'PayloadMax') if the board
+     * EDCL buffer is configured larger. */
+    static const int EDCL_PAYLOAD_MAX_BYTES  = 4*242;
+    static const int EDCL_PAYLOAD_DEFAULT_BYTES = 4*8;
+    /** Requests in flight without response (attribute 'Window'), the
+     * default waits each response as the MAC buffers one request. */
+    static const int EDCL_WINDOW_MAX = 64;
+    static const int EDCL_WINDOW_DEFAULT = 1;
+    /** offset, control and address fields before the data. */
+    static const int EDCL_HEADER_BYTES = 10;
+    static const int EDCL_SEQIDX_MASK = (1 << 14) - 1;
+    /** Sequential timeouts or bad responses before transaction is dropped */
+    static const int EDCL_RETRY_MAX = 3;
 
-    uint8_t tx_buf_[4096];
-    uint8_t rx_buf_[4096];
     IUdp *itransport_;
     AttributeType transport_;
     AttributeType seq_cnt_;
+    AttributeType payloadMax_;
+    AttributeType window_;
+
+    /** Header + maximal payload rounded up. */
+    static const int EDCL_DATAGRAM_MAX_BYTES = 1024;
+
+    // Datagram buffers of one batch:
+    uint8_t tx_buf_[EDCL_WINDOW_MAX][EDCL_DATAGRAM_MAX_BYTES];
+    uint8_t rx_buf_[EDCL_WINDOW_MAX][EDCL_DATAGRAM_MAX_BYTES];
+    UdpBatchItemType tx_items_[EDCL_WINDOW_MAX];
+    UdpBatchItemType rx_items_[EDCL_WINDOW_MAX];
+
+    // Requests in flight (ring buffer in order of sending):
+    int inflight_chunk_[EDCL_WINDOW_MAX];
+    uint32_t inflight_seq_[EDCL_WINDOW_MAX];
 };
 
 DECLARE_CLASS(EdclService)
@@ -0,0 +1,522 @@
+/**
+ * @file
+ * @copyright  Copyright 2016 GNSS Sensor Ltd. All right reserved.
+ * @author     Sergey Khabarov - sergeykhbr@gmail.com
+ * @brief      Shared memory datagram transport (local UDP replacement).
+ */
+
+#include "api_core.h"
+#include "shmtransport.h"
+#include <string.h>
+#if defined(_WIN32) || defined(__CYGWIN__)
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace debugger {
+
+#if defined(_WIN32) || defined(__CYGWIN__)
+struct ShmRingType {
+};
+struct ShmLayoutType {
+};
+#else
+static const uint32_t SHM_MAGIC = 0x53484d31;   // "SHM1"
+static const uint32_t SHM_RING_SIZE = 1 << 18;
+
+/**
+ * @brief Single producer/single consumer ring of datagrams.
+ * @details Each datagram is stored as 4-bytes length and data. Idle flags
+ *          tell the other side that semaphore has to be posted.
+ */
+struct ShmRingType {
+    std::atomic<uint32_t> wrcnt;
+    std::atomic<uint32_t> rdcnt;
+    std::atomic<uint32_t> rd_idle;
+    std::atomic<uint32_t> wr_idle;
+    sem_t sem_data;
+    sem_t sem_space;
+    uint8_t buf[SHM_RING_SIZE];
+};
+
+/** ring[0]: master to slave, ring[1]: slave to master. */
+struct ShmLayoutType {
+    std::atomic<uint32_t> magic;
+    ShmRingType ring[2];
+};
+
+static void ring_copy_to(ShmRingType *ring, uint32_t pos,
+                         const uint8_t *src, uint32_t sz) {
+    uint32_t off = pos % SHM_RING_SIZE;
+    uint32_t part = SHM_RING_SIZE - off;
+    if (part >= sz) {
+        memcpy(&ring->buf[off], src, sz);
+    } else {
+        memcpy(&ring->buf[off], src, part);
+        memcpy(ring->buf, &src[part], sz - part);
+    }
+}
+
+static void ring_copy_from(ShmRingType *ring, uint32_t pos,
+                           uint8_t *dst, uint32_t sz) {
+    uint32_t off = pos % SHM_RING_SIZE;
+    uint32_t part = SHM_RING_SIZE - off;
+    if (part >= sz) {
+        memcpy(dst, &ring->buf[off], sz);
+    } else {
+        memcpy(dst, &ring->buf[off], part);
+        memcpy(&dst[part], ring->buf, sz - part);
+    }
+}
+#endif
+
+/** Class registration in the Core */
+REGISTER_CLASS(ShmTransport)
+
+ShmTransport::ShmTransport(const char *name) : IService(name) {
+    registerInterface(static_cast<IUdp *>(this));
+    registerAttribute("ShmName", &shmName_);
+    registerAttribute("Master", &master_);
+    registerAttribute("Timeout", &timeout_);
+    registerAttribute("BlockingMode", &blockmode_);
+
+    shmName_.make_string("/riscv_edcl");
+    master_.make_boolean(false);
+    timeout_.make_int64(0);
+    blockmode_.make_boolean(true);
+
+    shm_ = 0;
+    attach_error_ = false;
+    shm_ino_ = 0;
+    deliver_ena_ = false;
+    rx_buf_ = 0;
+    RISCV_mutex_init(&mutexAttach_);
+    RISCV_mutex_init(&mutexListeners_);
+}
+
+ShmTransport::~ShmTransport() {
+    detach();
+    RISCV_mutex_destroy(&mutexAttach_);
+    RISCV_mutex_destroy(&mutexListeners_);
+    delete [] rx_buf_;
+}
+
+void ShmTransport::postinitService() {
+#if defined(_WIN32) || defined(__CYGWIN__)
+    RISCV_error("Shared memory transport isn't supported", NULL);
+#else
+    if (master_.to_bool()) {
+        attach();
+    }
+#endif
+}
+
+void ShmTransport::predeleteService() {
+    // Delivery task ends in SHM_DELIVER_WAIT_MS and isn't resubmitted
+    deliver_ena_ = false;
+}
+
+AttributeType ShmTransport::getConnectionSettings() {
+    AttributeType ret;
+    ret.make_dict();
+    ret["ShmName"] = shmName_;
+    return ret;
+}
+
+bool ShmTransport::setBlockingMode(socket_def h, bool mode) {
+    blockmode_.make_boolean(mode);
+    return true;
+}
+
+/**
+ * @details There's no descriptor to poll, so the first listener starts
+ *          delivery task that waits data in the ring and resubmits itself
+ *          into the thread pool until the service is predeleted.
+ */
+int ShmTransport::registerListener(IRawListener *ilistener) {
+#if defined(_WIN32) || defined(__CYGWIN__)
+    return -1;
+#else
+    RISCV_mutex_lock(&mutexListeners_);
+    vecListeners_.push_back(ilistener);
+    bool start = rx_buf_ == 0;
+    if (start) {
+        rx_buf_ = new uint8_t[SHM_DATAGRAM_MAX];
+        deliver_ena_ = true;
+    }
+    RISCV_mutex_unlock(&mutexListeners_);
+    if (start) {
+        RISCV_submit(runDeliver, this);
+    }
+    return 0;
+#endif
+}
+
+void ShmTransport::runDeliver(void *args) {
+    reinterpret_cast<ShmTransport *>(args)->deliverData();
+}
+
+void ShmTransport::deliverData() {
+    if (!deliver_ena_.load()) {
+        return;
+    }
+    ShmLayoutType *shm = attach();
+    if (!shm) {
+        RISCV_sleep_ms(SHM_DELIVER_WAIT_MS);
+    } else {
+        int len = readRing(shm, rx_buf_, SHM_DATAGRAM_MAX,
+                           SHM_DELIVER_WAIT_MS);
+        if (len == 0 && isReplaced(shm)) {
+            detachStale(shm);
+        }
+        while (len > 0) {
+            RISCV_mutex_lock(&mutexListeners_);
+            for (unsigned i = 0; i < vecListeners_.size(); i++) {
+                vecListeners_[i]->updateData(
+                        reinterpret_cast<char *>(rx_buf_), len);
+            }
+            RISCV_mutex_unlock(&mutexListeners_);
+            len = readRing(shm, rx_buf_, SHM_DATAGRAM_MAX, 0);
+        }
+    }
+    if (deliver_ena_.load()) {
+        RISCV_submit(runDeliver, this);
+    }
+}
+
+/**
+ * @brief Get mapped shared object, map it if needed.
+ * @details Slave retries to attach on each transfer until master marks
+ *          memory as valid and re-attaches when the mapped memory is
+ *          marked invalid by exiting master.
+ * @return Mapped memory or 0 if the other side isn't ready.
+ */
+ShmLayoutType *ShmTransport::attach() {
+#if defined(_WIN32) || defined(__CYGWIN__)
+    return 0;
+#else
+    bool master = master_.to_bool();
+    ShmLayoutType *shm = shm_.load();
+    if (shm && (master
+        || shm->magic.load(std::memory_order_acquire) == SHM_MAGIC)) {
+        return shm;
+    }
+    RISCV_mutex_lock(&mutexAttach_);
+    shm = shm_.load();
+    if (shm && !master && shm->magic.load() != SHM_MAGIC) {
+        stale_.push_back(shm);
+        shm = 0;
+    }
+    if (!shm) {
+        shm = mapObject();
+        shm_.store(shm);
+    }
+    RISCV_mutex_unlock(&mutexAttach_);
+    return shm;
+#endif
+}
+
+/**
+ * @brief Map shared object.
+ * @details Master removes an object left by the previous run and creates
+ *          a new one, so a slave still mapping the old object is never
+ *          re-initialized under its feet.
+ */
+ShmLayoutType *ShmTransport::mapObject() {
+#if defined(_WIN32) || defined(__CYGWIN__)
+    return 0;
+#else
+    bool master = master_.to_bool();
+    int oflags = O_RDWR;
+    if (master) {
+        shm_unlink(shmName_.to_string());
+        oflags |= O_CREAT | O_EXCL;
+    }
+    int fd = shm_open(shmName_.to_string(), oflags, 0600);
+    if (fd < 0) {
+        if (master && !attach_error_) {
+            RISCV_error("Can't create shared memory '%s'",
+                        shmName_.to_string());
+            attach_error_ = true;
+        }
+        return 0;
+    }
+    if (master && ftruncate(fd, sizeof(ShmLayoutType)) != 0) {
+        close(fd);
+        RISCV_error("Can't allocate shared memory '%s'", shmName_.to_string());
+        return 0;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0
+        || static_cast<size_t>(st.st_size) < sizeof(ShmLayoutType)) {
+        // Master hasn't allocated memory yet
+        close(fd);
+        return 0;
+    }
+    void *p = mmap(NULL, sizeof(ShmLayoutType), PROT_READ | PROT_WRITE,
+                   MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        RISCV_error("Can't map shared memory '%s'", shmName_.to_string());
+        return 0;
+    }
+
+    ShmLayoutType *shm = static_cast<ShmLayoutType *>(p);
+    if (master) {
+        for (int i = 0; i < 2; i++) {
+            ShmRingType *ring = &shm->ring[i];
+            ring->wrcnt.store(0);
+            ring->rdcnt.store(0);
+            ring->rd_idle.store(0);
+            ring->wr_idle.store(0);
+            sem_init(&ring->sem_data, 1, 0);
+            sem_init(&ring->sem_space, 1, 0);
+        }
+        shm->magic.store(SHM_MAGIC, std::memory_order_release);
+    } else if (shm->magic.load(std::memory_order_acquire) != SHM_MAGIC) {
+        munmap(p, sizeof(ShmLayoutType));
+        return 0;
+    }
+    shm_ino_ = static_cast<uint64_t>(st.st_ino);
+    RISCV_info("Shared memory '%s' attached as %s", shmName_.to_string(),
+                master ? "master" : "slave");
+    return shm;
+#endif
+}
+
+void ShmTransport::detach() {
+#if defined(_WIN32) || defined(__CYGWIN__)
+#else
+    for (unsigned i = 0; i < stale_.size(); i++) {
+        munmap(stale_[i], sizeof(ShmLayoutType));
+    }
+    stale_.clear();
+    ShmLayoutType *shm = shm_.load();
+    if (!shm) {
+        return;
+    }
+    if (master_.to_bool()) {
+        // Release slave waiting in the rings and make it re-attach
+        shm->magic.store(0);
+        for (int i = 0; i < 2; i++) {
+            RISCV_semaphore_post(&shm->ring[i].sem_data);
+            RISCV_semaphore_post(&shm->ring[i].sem_space);
+        }
+        shm_unlink(shmName_.to_string());
+    }
+    munmap(shm, sizeof(ShmLayoutType));
+    shm_ = 0;
+#endif
+}
+
+/**
+ * @brief Slave forgets the object of the exited master.
+ * @details Memory stays mapped until destruction because the other
+ *          thread may still be sending or receiving through it.
+ */
+void ShmTransport::detachStale(ShmLayoutType *shm) {
+    RISCV_mutex_lock(&mutexAttach_);
+    if (shm_.load() == shm) {
+        stale_.push_back(shm);
+        shm_ = 0;
+    }
+    RISCV_mutex_unlock(&mutexAttach_);
+}
+
+/**
+ * @brief Slave's mapping was left by a master that didn't exit properly.
+ * @details Checked only after waiting timeout, when the name refers to
+ *          another object or doesn't exist anymore.
+ */
+bool ShmTransport::isReplaced(ShmLayoutType *shm) {
+#if defined(_WIN32) || defined(__CYGWIN__)
+    return false;
+#else
+    if (master_.to_bool()) {
+        return false;
+    }
+    int fd = shm_open(shmName_.to_string(), O_RDONLY, 0600);
+    if (fd < 0) {
+        return true;
+    }
+    struct stat st;
+    bool ret = fstat(fd, &st) != 0
+            || static_cast<uint64_t>(st.st_ino) != shm_ino_;
+    close(fd);
+    return ret;
+#endif
+}
+
+/** Waiting time in ms, -1 means infinite. */
+int ShmTransport::waitTimeout() {
+    int ms = static_cast<int>(timeout_.to_int64());
+    return ms ? ms : -1;
+}
+
+bool ShmTransport::writeRing(ShmLayoutType *shm, const uint8_t *msg,
+                             int len) {
+#if defined(_WIN32) || defined(__CYGWIN__)
+    return false;
+#else
+    ShmRingType *ring = &shm->ring[master_.to_bool() ? 0 : 1];
+    uint32_t need = static_cast<uint32_t>(len) + 4;
+    uint32_t wr = ring->wrcnt.load(std::memory_order_relaxed);
+    int ms = waitTimeout();
+    uint64_t t_end = RISCV_get_time_ms() + static_cast<uint64_t>(ms);
+    while (SHM_RING_SIZE
+        - (wr - ring->rdcnt.load(std::memory_order_acquire)) < need) {
+        // Mark as idle and re-check to avoid lost wake-up
+        ring->wr_idle.store(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (SHM_RING_SIZE - (wr - ring->rdcnt.load()) >= need) {
+            ring->wr_idle.store(0);
+            break;
+        }
+        int tmo = 0;
+        if (ms < 0) {
+            RISCV_semaphore_wait(&ring->sem_space);
+        } else {
+            uint64_t t = RISCV_get_time_ms();
+            tmo = t >= t_end ? 1 : RISCV_semaphore_wait_ms(&ring->sem_space,
+                                            static_cast<int>(t_end - t));
+        }
+        ring->wr_idle.store(0);
+        if (tmo || shm->magic.load() != SHM_MAGIC) {
+            return false;
+        }
+    }
+
+    uint8_t hdr[4];
+    hdr[0] = static_cast<uint8_t>(len);
+    hdr[1] = static_cast<uint8_t>(len >> 8);
+    hdr[2] = static_cast<uint8_t>(len >> 16);
+    hdr[3] = static_cast<uint8_t>(len >> 24);
+    ring_copy_to(ring, wr, hdr, 4);
+    ring_copy_to(ring, wr + 4, msg, static_cast<uint32_t>(len));
+    ring->wrcnt.store(wr + need, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (ring->rd_idle.load(std::memory_order_relaxed)) {
+        RISCV_semaphore_post(&ring->sem_data);
+    }
+    return true;
+#endif
+}
+
+/**
+ * @param[in] ms Waiting time: 0 doesn't wait, -1 waits infinitely.
+ * @return Datagram length, 0 if ring is empty after waiting.
+ */
+int ShmTransport::readRing(ShmLayoutType *shm, uint8_t *buf, int maxlen,
+                           int ms) {
+#if defined(_WIN32) || defined(__CYGWIN__)
+    return 0;
+#else
+    ShmRingType *ring = &shm->ring[master_.to_bool() ? 1 : 0];
+    uint32_t rd = ring->rdcnt.load(std::memory_order_relaxed);
+    uint64_t t_end = RISCV_get_time_ms() + static_cast<uint64_t>(ms);
+    while (ring->wrcnt.load(std::memory_order_acquire) == rd) {
+        if (ms == 0) {
+            return 0;
+        }
+        ring->rd_idle.store(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (ring->wrcnt.load() != rd) {
+            ring->rd_idle.store(0);
+            break;
+        }
+        int tmo = 0;
+        if (ms < 0) {
+            RISCV_semaphore_wait(&ring->sem_data);
+        } else {
+            uint64_t t = RISCV_get_time_ms();
+            tmo = t >= t_end ? 1 : RISCV_semaphore_wait_ms(&ring->sem_data,
+                                            static_cast<int>(t_end - t));
+        }
+        ring->rd_idle.store(0);
+        if (tmo || shm->magic.load() != SHM_MAGIC) {
+            return 0;
+        }
+    }
+
+    uint8_t hdr[4];
+    ring_copy_from(ring, rd, hdr, 4);
+    int len = hdr[0] | (hdr[1] << 8) | (hdr[2] << 16) | (hdr[3] << 24);
+    int rdlen = len;
+    if (rdlen > maxlen) {
+        RISCV_error("Receiver's buffer overflow maxlen = %d", maxlen);
+        rdlen = maxlen;
+    }
+    ring_copy_from(ring, rd + 4, buf, static_cast<uint32_t>(rdlen));
+    ring->rdcnt.store(rd + 4 + static_cast<uint32_t>(len),
+                      std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (ring->wr_idle.load(std::memory_order_relaxed)) {
+        RISCV_semaphore_post(&ring->sem_space);
+    }
+    return rdlen;
+#endif
+}
+
+int ShmTransport::sendData(const uint8_t *msg, int len) {
+    ShmLayoutType *shm = len <= SHM_DATAGRAM_MAX ? attach() : 0;
+    if (!shm) {
+        return 1;
+    }
+    if (!writeRing(shm, msg, len)) {
+        RISCV_error("Shared memory ring is full", NULL);
+        return 1;
+    }
+    return len;
+}
+
+int ShmTransport::readData(const uint8_t *buf, int maxlen) {
+    ShmLayoutType *shm = attach();
+    if (!shm) {
+        if (blockmode_.to_bool()) {
+            // Don't spin while the other side isn't started
+            RISCV_sleep_ms(timeout_.to_int64() ?
+                           static_cast<int>(timeout_.to_int64()) : 100);
+        }
+        return 0;
+    }
+    int ret = readRing(shm, const_cast<uint8_t *>(buf), maxlen,
+                       blockmode_.to_bool() ? waitTimeout() : 0);
+    if (ret == 0 && blockmode_.to_bool() && isReplaced(shm)) {
+        detachStale(shm);
+    }
+    return ret;
+}
+
+int ShmTransport::sendDataBatch(UdpBatchItemType *items, int cnt) {
+    for (int i = 0; i < cnt; i++) {
+        items[i].len = sendData(items[i].buf, items[i].size);
+        if (items[i].len != items[i].size) {
+            return i ? i : -1;
+        }
+    }
+    return cnt;
+}
+
+int ShmTransport::readDataBatch(UdpBatchItemType *items, int cnt) {
+    if (cnt <= 0) {
+        return 0;
+    }
+    int res = readData(items[0].buf, items[0].size);
+    if (res <= 0) {
+        return res;
+    }
+    items[0].len = res;
+    int total = 1;
+    ShmLayoutType *shm = attach();
+    while (shm && total < cnt) {
+        res = readRing(shm, items[total].buf, items[total].size, 0);
+        if (res == 0) {
+            break;
+        }
+        items[total++].len = res;
+    }
+    return total;
+}
+
+}  // namespace debugger
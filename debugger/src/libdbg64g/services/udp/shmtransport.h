@@ -0,0 +1,91 @@
+/**
+ * @file
+ * @copyright  Copyright 2016 GNSS Sensor Ltd. All right reserved.
+ * @author     Sergey Khabarov - sergeykhbr@gmail.com
+ * @brief      Shared memory datagram transport (local UDP replacement).
+ */
+
+#ifndef __DEBUGGER_SHM_TRANSPORT_H__
+#define __DEBUGGER_SHM_TRANSPORT_H__
+
+#include "iclass.h"
+#include "iservice.h"
+#include "coreservices/iudp.h"
+#include <atomic>
+#include <vector>
+
+namespace debugger {
+
+struct ShmLayoutType;
+struct ShmRingType;
+
+/**
+ * @brief IUdp over a pair of single producer/single consumer rings.
+ * @details Both sides map the same POSIX shared memory object 'ShmName'.
+ *          Side with 'Master' = true creates and initializes it, the other
+ *          side attaches on the first transfer, so the debugger and the
+ *          simulator may run in one or in two processes. Data is copied
+ *          directly into the ring, process-shared semaphores are used only
+ *          when the reader waits for data or the writer waits for space.
+ *          Registered listeners get the received datagrams from a task
+ *          of the core thread pool, readData() mustn't be used then.
+ */
+class ShmTransport : public IService,
+                     public IUdp {
+public:
+    explicit ShmTransport(const char *name);
+    virtual ~ShmTransport();
+
+    /** IService interface */
+    virtual void postinitService();
+    virtual void predeleteService();
+
+    /** IUdp interface */
+    virtual AttributeType getConnectionSettings();
+    virtual void setTargetSettings(const AttributeType *target) {}
+    virtual bool setBlockingMode(socket_def h, bool mode);
+    virtual int sendData(const uint8_t *msg, int len);
+    virtual int readData(const uint8_t *buf, int maxlen);
+    virtual int sendDataBatch(UdpBatchItemType *items, int cnt);
+    virtual int readDataBatch(UdpBatchItemType *items, int cnt);
+    virtual int registerListener(IRawListener *ilistener);
+
+private:
+    ShmLayoutType *attach();
+    ShmLayoutType *mapObject();
+    void detach();
+    void detachStale(ShmLayoutType *shm);
+    bool isReplaced(ShmLayoutType *shm);
+    bool writeRing(ShmLayoutType *shm, const uint8_t *msg, int len);
+    int readRing(ShmLayoutType *shm, uint8_t *buf, int maxlen, int ms);
+    int waitTimeout();
+    static void runDeliver(void *args);
+    void deliverData();
+
+private:
+    /** Maximal datagram size, the same as UDP receiver buffer. */
+    static const int SHM_DATAGRAM_MAX = 4096;
+    /** Listeners delivery task waits data not longer and resubmits. */
+    static const int SHM_DELIVER_WAIT_MS = 100;
+
+    AttributeType shmName_;
+    AttributeType master_;
+    AttributeType timeout_;
+    AttributeType blockmode_;
+
+    std::vector<IRawListener *> vecListeners_;
+    mutex_def mutexListeners_;
+    std::atomic<ShmLayoutType *> shm_;
+    mutex_def mutexAttach_;
+    bool attach_error_;
+    uint64_t shm_ino_;
+    std::atomic<bool> deliver_ena_;
+    uint8_t *rx_buf_;
+    std::vector<ShmLayoutType *> stale_;
+};
+
+DECLARE_CLASS(ShmTransport)
+
+}  // namespace debugger
+
+#endif  // __DEBUGGER_SHM_TRANSPORT_H__
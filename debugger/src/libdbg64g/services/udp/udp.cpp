@@ -10,6 +10,13 @@
 
 namespace debugger {
 
+#if defined(_WIN32) || defined(__CYGWIN__)
+#define UDP_RECV_FLAGS 0
+#else
+/** Return the real datagram length to detect receiver's buffer overflow */
+#define UDP_RECV_FLAGS MSG_TRUNC
+#endif
+
 /** Class registration in the Core */
 REGISTER_CLASS(UdpService)
 
@@ -20,15 +27,23 @@ UdpService::UdpService(const char *name)
     registerAttribute("BlockingMode", &blockmode_);
     registerAttribute("HostIP", &hostIP_);
     registerAttribute("BoardIP", &boardIP_);
+    registerAttribute("Reactor", &reactor_);
 
     timeout_.make_int64(0);
     blockmode_.make_boolean(true);
     hostIP_.make_string("192.168.0.53");
     boardIP_.make_string("192.168.0.51");
+    reactor_.make_string("");
+    ireactor_ = 0;
+    rx_notified_ = 0;
+    rx_buf_ = 0;
+    RISCV_event_create(&rx_ready_, "udp_rx_ready");
 }
 
 UdpService::~UdpService() {
     closeDatagramSocket();
+    RISCV_event_close(&rx_ready_);
+    delete [] rx_buf_;
 }
 
 void UdpService::postinitService() {
@@ -55,13 +70,86 @@ void UdpService::postinitService() {
     if (!blockmode_.to_bool()) {
         setBlockingMode(hsock_, false);
     }
+
+    if (reactor_.size()) {
+        IReactor *ireactor = static_cast<IReactor *>(
+            RISCV_get_service_iface(reactor_.to_string(), IFACE_REACTOR));
+        if (!ireactor) {
+            RISCV_error("Reactor '%s' not found", reactor_.to_string());
+        } else if (ireactor->registerReadHandler(hsock_,
+                        static_cast<IReactorListener *>(this)) == 0) {
+            ireactor_ = ireactor;
+        }
+    }
+}
+
+void UdpService::predeleteService() {
+    if (ireactor_) {
+        ireactor_->unregisterReadHandler(hsock_);
+        ireactor_ = 0;
+        // Release reader waiting notification
+        RISCV_event_set(&rx_ready_);
+    }
+}
+
+void UdpService::readyRead(socket_def fd) {
+    RISCV_event_set(&rx_ready_);
+    if (vecListeners_.size() && rx_notified_++ == 0) {
+        RISCV_submit(runDeliver, this);
+    }
 }
 
+/**
+ * @brief Received datagrams are delivered to the listeners.
+ * @details Delivery is driven by the reactor notifications, so 'Reactor'
+ *          should be defined. Listeners are called from the core thread
+ *          pool and shouldn't read the socket themselves.
+ */
 int UdpService::registerListener(IRawListener *ilistener) { 
+    if (reactor_.size() == 0) {
+        RISCV_error("Listener requires 'Reactor'", NULL);
+        return -1;
+    }
+    if (!rx_buf_) {
+        rx_buf_ = new uint8_t[UDP_BATCH_MAX * UDP_DATAGRAM_MAX];
+        for (int i = 0; i < UDP_BATCH_MAX; i++) {
+            rx_items_[i].buf = &rx_buf_[i * UDP_DATAGRAM_MAX];
+            rx_items_[i].size = UDP_DATAGRAM_MAX;
+            rx_items_[i].len = 0;
+        }
+    }
     vecListeners_.push_back(ilistener);
     return 0;
 }
 
+void UdpService::runDeliver(void *args) {
+    reinterpret_cast<UdpService *>(args)->deliverData();
+}
+
+/**
+ * Notifications counted while the socket was read don't start another
+ * task, they are served by this one so that datagrams keep their order.
+ */
+void UdpService::deliverData() {
+    int notified;
+    do {
+        notified = rx_notified_.load();
+        while (isReadable()) {
+            int cnt = readDataBatch(rx_items_, UDP_BATCH_MAX);
+            if (cnt <= 0) {
+                break;
+            }
+            for (int i = 0; i < cnt; i++) {
+                for (unsigned n = 0; n < vecListeners_.size(); n++) {
+                    vecListeners_[n]->updateData(
+                        reinterpret_cast<char *>(rx_items_[i].buf),
+                        rx_items_[i].len);
+                }
+            }
+        }
+    } while ((rx_notified_ -= notified) != 0);
+}
+
 int UdpService::createDatagramSocket() {
     char hostName[256];
     if(gethostname(hostName, sizeof(hostName)) < 0) {
@@ -183,57 +271,196 @@ int UdpService::sendData(const uint8_t *msg, int len) {
         RISCV_error("sendto() failed\n", NULL);
 #endif
         return 1;
-    } else {
-        char dbg[1024];
-        int pos = RISCV_sprintf(dbg, sizeof(dbg), "send  %d bytes to %s:%d: ",
-                                tx_bytes,
-                                inet_ntoa(remote_sockaddr_ipv4_.sin_addr),
-                                ntohs(remote_sockaddr_ipv4_.sin_port));
-
-        if (tx_bytes < 64) {
-            for (int i = 0; i < len; i++) {
-                pos += RISCV_sprintf(&dbg[pos], sizeof(dbg) - pos, 
-                                                "%02x", msg[i] & 0xFF);
-            }
-        }
-        RISCV_debug("%s", dbg);
     }
+    dumpDatagram(true, msg, tx_bytes);
     return tx_bytes;
 }
 
 int UdpService::readData(const uint8_t *buf, int maxlen) {
-    int sockerr;
-    addr_size_t sockerr_len = sizeof(sockerr);
     addr_size_t addr_sz = sizeof(sockaddr_ipv4_);
+    uint8_t *rxbuf = const_cast<uint8_t *>(buf);
 
-    int res = recvfrom(hsock_, rcvbuf, sizeof(rcvbuf),
-                        0, (struct sockaddr *)&sockaddr_ipv4_, &addr_sz);
-    getsockopt(hsock_, SOL_SOCKET, SO_ERROR, 
-                            (char *)&sockerr, &sockerr_len);
-
-    if (res < 0 && sockerr < 0) {
-        RISCV_error("Socket error %x", sockerr);
-        res = -1;
-    } else if (res < 0 && sockerr == 0) {
-        // Timeout:
-        res = 0;
-    } else if (res > 0) {
+    if (!waitData()) {
+        return 0;
+    }
+    int res = recvfrom(hsock_, reinterpret_cast<char *>(rxbuf), maxlen,
+                       UDP_RECV_FLAGS, (struct sockaddr *)&sockaddr_ipv4_,
+                       &addr_sz);
+    res = checkRecvError(res);
+    if (res > 0) {
         if (maxlen < res) {
             res = maxlen;
             RISCV_error("Receiver's buffer overflow maxlen = %d", maxlen);
         }
-        memcpy(const_cast<uint8_t *>(buf), rcvbuf, res);
-        char dbg[1024];
-        int pos = RISCV_sprintf(dbg, sizeof(dbg), "received  %d Bytes: ", res);
-        if (res < 64) {
-            for (int i = 0; i < res; i++) {
-                pos += RISCV_sprintf(&dbg[pos], sizeof(dbg) - pos, 
-                                    "%02x", rcvbuf[i] & 0xFF);
-            }
+        dumpDatagram(false, rxbuf, res);
+    }
+    return res;
+}
+
+int UdpService::sendDataBatch(UdpBatchItemType *items, int cnt) {
+    int total = 0;
+#if defined(_WIN32) || defined(__CYGWIN__)
+    for (total = 0; total < cnt; total++) {
+        items[total].len = sendData(items[total].buf, items[total].size);
+        if (items[total].len != items[total].size) {
+            return total ? total : -1;
         }
-        RISCV_debug("%s", dbg);
+    }
+#else
+    struct mmsghdr msgs[UDP_BATCH_MAX];
+    struct iovec iov[UDP_BATCH_MAX];
+    while (total < cnt) {
+        int n = cnt - total;
+        if (n > UDP_BATCH_MAX) {
+            n = UDP_BATCH_MAX;
+        }
+        memset(msgs, 0, n * sizeof(struct mmsghdr));
+        for (int i = 0; i < n; i++) {
+            iov[i].iov_base = items[total + i].buf;
+            iov[i].iov_len = items[total + i].size;
+            msgs[i].msg_hdr.msg_name = &remote_sockaddr_ipv4_;
+            msgs[i].msg_hdr.msg_namelen = sizeof(remote_sockaddr_ipv4_);
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int res = sendmmsg(hsock_, msgs, n, 0);
+        if (res <= 0) {
+            RISCV_error("sendmmsg() failed", NULL);
+            return total ? total : -1;
+        }
+        for (int i = 0; i < res; i++) {
+            items[total + i].len = static_cast<int>(msgs[i].msg_len);
+            dumpDatagram(true, items[total + i].buf, items[total + i].len);
+        }
+        total += res;
+    }
+#endif
+    return total;
+}
+
+int UdpService::readDataBatch(UdpBatchItemType *items, int cnt) {
+    int total = 0;
+    if (cnt <= 0) {
+        return 0;
+    }
+#if defined(_WIN32) || defined(__CYGWIN__)
+    // Blocking read of the first datagram, others only if already queued
+    do {
+        int res = readData(items[total].buf, items[total].size);
+        if (res <= 0) {
+            return total ? total : res;
+        }
+        items[total++].len = res;
+    } while (total < cnt && isReadable());
+#else
+    struct mmsghdr msgs[UDP_BATCH_MAX];
+    struct iovec iov[UDP_BATCH_MAX];
+    if (cnt > UDP_BATCH_MAX) {
+        cnt = UDP_BATCH_MAX;
+    }
+    if (!waitData()) {
+        return 0;
+    }
+    memset(msgs, 0, cnt * sizeof(struct mmsghdr));
+    for (int i = 0; i < cnt; i++) {
+        iov[i].iov_base = items[i].buf;
+        iov[i].iov_len = items[i].size;
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    int res = checkRecvError(
+                recvmmsg(hsock_, msgs, cnt, MSG_WAITFORONE, NULL));
+    if (res <= 0) {
+        return res;
+    }
+    for (total = 0; total < res; total++) {
+        items[total].len = static_cast<int>(msgs[total].msg_len);
+        if (msgs[total].msg_hdr.msg_flags & MSG_TRUNC) {
+            RISCV_error("Receiver's buffer overflow maxlen = %d",
+                        items[total].size);
+        }
+        dumpDatagram(false, items[total].buf, items[total].len);
+    }
+#endif
+    return total;
+}
+
+/**
+ * @brief Wait input notification from the reactor.
+ * @details In the reactor mode receiver sleeps on the event instead of
+ *          blocking in (or spinning around) the socket call. 'Timeout'
+ *          limits waiting in both blocking and non-blocking modes.
+ * @return false on timeout.
+ */
+bool UdpService::waitData() {
+    if (!ireactor_) {
+        return true;
+    }
+    // Clear before check: datagram received after check sets event again
+    RISCV_event_clear(&rx_ready_);
+    if (isReadable()) {
+        return true;
+    }
+    int ms = static_cast<int>(timeout_.to_int64());
+    if (ms == 0) {
+        if (!blockmode_.to_bool()) {
+            return false;
+        }
+        RISCV_event_wait(&rx_ready_);
+    } else if (RISCV_event_wait_ms(&rx_ready_, ms)) {
+        return false;
+    }
+    return isReadable();
+}
+
+int UdpService::checkRecvError(int res) {
+    int sockerr;
+    addr_size_t sockerr_len = sizeof(sockerr);
+    if (res >= 0) {
+        return res;
+    }
+    getsockopt(hsock_, SOL_SOCKET, SO_ERROR, 
+                            (char *)&sockerr, &sockerr_len);
+    if (sockerr < 0) {
+        RISCV_error("Socket error %x", sockerr);
+        return -1;
+    } else if (sockerr == 0) {
+        // Timeout:
+        return 0;
     }
     return res;
 }
 
+bool UdpService::isReadable() {
+    fd_set rset;
+    struct timeval tv = {0, 0};
+    FD_ZERO(&rset);
+    FD_SET(hsock_, &rset);
+    return select(static_cast<int>(hsock_) + 1, &rset, NULL, NULL, &tv) > 0;
+}
+
+/** Hex dump is formatted only when debug output is enabled. */
+void UdpService::dumpDatagram(bool tx, const uint8_t *buf, int len) {
+    if (getLogLevel() < LOG_DEBUG) {
+        return;
+    }
+    char dbg[1024];
+    int pos;
+    if (tx) {
+        pos = RISCV_sprintf(dbg, sizeof(dbg), "send  %d bytes to %s:%d: ",
+                            len,
+                            inet_ntoa(remote_sockaddr_ipv4_.sin_addr),
+                            ntohs(remote_sockaddr_ipv4_.sin_port));
+    } else {
+        pos = RISCV_sprintf(dbg, sizeof(dbg), "received  %d Bytes: ", len);
+    }
+    if (len < 64) {
+        for (int i = 0; i < len; i++) {
+            pos += RISCV_sprintf(&dbg[pos], sizeof(dbg) - pos, 
+                                "%02x", buf[i] & 0xFF);
+        }
+    }
+    RISCV_debug("%s", dbg);
+}
+
 }  // namespace debugger
@@ -11,18 +11,22 @@
 #include "iclass.h"
 #include "iservice.h"
 #include "coreservices/iudp.h"
+#include "coreservices/ireactor.h"
 #include <vector>
+#include <atomic>
 
 namespace debugger {
 
 class UdpService : public IService, 
-                   public IUdp {
+                   public IUdp,
+                   public IReactorListener {
 public:
     UdpService(const char *name);
     ~UdpService();
 
     /** IService interface */
     virtual void postinitService();
+    virtual void predeleteService();
 
     /** IUdp interface */
     virtual AttributeType getConnectionSettings() {
@@ -56,25 +60,51 @@ public:
 
     virtual int readData(const uint8_t *buf, int maxlen);
 
+    virtual int sendDataBatch(UdpBatchItemType *items, int cnt);
+
+    virtual int readDataBatch(UdpBatchItemType *items, int cnt);
+
     virtual int registerListener(IRawListener *ilistener);
 
+    /** IReactorListener interface */
+    virtual void readyRead(socket_def fd);
+
 protected:
     int createDatagramSocket();
     void closeDatagramSocket();
 
 private:
+    int checkRecvError(int res);
+    bool waitData();
+    bool isReadable();
+    void dumpDatagram(bool tx, const uint8_t *buf, int len);
+    static void runDeliver(void *args);
+    void deliverData();
+
+private:
+    /** Maximum number of datagrams per one sendmmsg()/recvmmsg() call. */
+    static const int UDP_BATCH_MAX = 64;
+    /** Buffer of one datagram delivered to the listeners. */
+    static const int UDP_DATAGRAM_MAX = 2048;
+
     std::vector<IRawListener *> vecListeners_;
+    // Delivery to listeners, one pool task at a time:
+    std::atomic<int> rx_notified_;
+    uint8_t *rx_buf_;
+    UdpBatchItemType rx_items_[UDP_BATCH_MAX];
     AttributeType timeout_;
     AttributeType blockmode_;
     AttributeType hostIP_;
     AttributeType boardIP_;
+    AttributeType reactor_;
     
     struct sockaddr_in sockaddr_ipv4_;
     char               sockaddr_ipv4_str_[16];    // 3 dots  + 4 digits each 3 symbols + '\0' = 4*3 + 3 + 1;
     unsigned short     sockaddr_ipv4_port_;
     struct sockaddr_in remote_sockaddr_ipv4_;
     socket_def hsock_;
-    char rcvbuf[4096];
+    IReactor *ireactor_;
+    event_def rx_ready_;
 };
 
 DECLARE_CLASS(UdpService)
@@ -10,19 +10,34 @@
 
 namespace debugger {
 
+/** CSRs of the context block in order of DsuContextType::csr. */
+static const uint16_t DSU_CONTEXT_CSR[DSU_CONTEXT_CSR_NUM] = {
+    0x300, 0x301, 0x304, 0x344, 0x341, 0x342, 0x343, 0x701
+};
+
 DSU::DSU(const char *name)  : IService(name) {
     registerInterface(static_cast<IMemoryOperation *>(this));
     registerAttribute("BaseAddress", &baseAddress_);
     registerAttribute("Length", &length_);
     registerAttribute("HostIO", &hostio_);
+    registerAttribute("Bus", &bus_);
 
     baseAddress_.make_uint64(0);
     length_.make_uint64(0);
     hostio_.make_string("");
+    bus_.make_string("");
     map_ = reinterpret_cast<DsuMapType *>(0);
+    ihostio_ = 0;
+    iclk_ = 0;
+    ibus_ = 0;
+    step_cnt_ = 0;
+    crc_addr_ = 0;
+    crc_page_ = 4096;
+    crc_buf_ = new uint8_t[DSU_CRC_PAGE_MAX];
 }
 
 DSU::~DSU() {
+    delete [] crc_buf_;
 }
 
 void DSU::postinitService() {
@@ -31,6 +46,20 @@ void DSU::postinitService() {
     if (!ihostio_) {
         RISCV_error("Can't find IHostIO interface %s", hostio_.to_string());
     }
+
+    AttributeType clks;
+    RISCV_get_clock_services(&clks);
+    if (clks.size()) {
+        iclk_ = static_cast<IClock *>(clks[0u].to_iface());
+    }
+
+    if (bus_.size()) {
+        ibus_ = static_cast<IBus *>(
+            RISCV_get_service_iface(bus_.to_string(), IFACE_BUS));
+        if (!ibus_) {
+            RISCV_error("Can't find IBus interface %s", bus_.to_string());
+        }
+    }
 }
 
 void DSU::transaction(Axi4TransactionType *payload) {
@@ -79,6 +108,12 @@ void DSU::regionControlRd(uint64_t off, Axi4TransactionType *payload) {
         read64(step_cnt_, off, payload->xsize, payload->rpayload);
     } else if (off64 == &map_->add_breakpoint) {
     } else if (off64 == &map_->remove_breakpoint) {
+    } else if (off64 == &map_->speed_ratio) {
+        val = static_cast<uint64_t>(1000.0 * idbg->getSimWallRatio());
+        read64(val, off, payload->xsize, payload->rpayload);
+    } else if (off64 == &map_->speed_mode) {
+        val = idbg->isRealTime() ? 1 : 0;
+        read64(val, off, payload->xsize, payload->rpayload);
     } else if (off64 >= &map_->cpu_regs[0] 
         && off64 < &map_->cpu_regs[DSU_GENERAL_CORE_REGS_NUM] ) {
         uint64_t idx = reinterpret_cast<uint64_t>(off64) 
@@ -92,7 +127,100 @@ void DSU::regionControlRd(uint64_t off, Axi4TransactionType *payload) {
     } else if (off64 == &map_->npc) {
         val = idbg->getNPC();
         read64(val, off, payload->xsize, payload->rpayload);
+    } else if (off64 >= &map_->context
+        && off64 < &(&map_->context)[1]) {
+        uint64_t idx = reinterpret_cast<uint64_t>(off64) 
+                - reinterpret_cast<uint64_t>(&map_->context);
+        val = readContext(idx / 8);
+        read64(val, off, payload->xsize, payload->rpayload);
+    } else if (off64 == &map_->trace_size) {
+        val = idbg->getTraceSize();
+        read64(val, off, payload->xsize, payload->rpayload);
+    } else if (off64 == &map_->trace_count) {
+        val = idbg->getTraceCount();
+        read64(val, off, payload->xsize, payload->rpayload);
+    } else if (off64 == &map_->crc_addr) {
+        read64(crc_addr_, off, payload->xsize, payload->rpayload);
+    } else if (off64 == &map_->crc_page) {
+        read64(crc_page_, off, payload->xsize, payload->rpayload);
+    } else if (off64 >= &map_->crc[0]
+        && off64 < &map_->crc[DSU_CRC_PAGES_MAX]) {
+        uint64_t idx = reinterpret_cast<uint64_t>(off64) 
+                - reinterpret_cast<uint64_t>(&map_->crc);
+        val = readCrc(idx / 8);
+        read64(val, off, payload->xsize, payload->rpayload);
+    } else if (off64 >= &map_->trace[0]
+        && off64 < &map_->trace[DSU_TRACE_ENTRIES_MAX]) {
+        uint64_t idx = reinterpret_cast<uint64_t>(off64) 
+                - reinterpret_cast<uint64_t>(&map_->trace);
+        val = readTrace(idx / 8);
+        read64(val, off, payload->xsize, payload->rpayload);
+    }
+}
+
+/**
+ * Context words are collected from the CPU at the moment of reading. Bus
+ * tap executes all requests of one list in the CPU thread, so a burst
+ * is a consistent snapshot of the halted CPU.
+ */
+uint64_t DSU::readContext(uint64_t idx) {
+    ICpuRiscV *idbg = ihostio_->getCpuInterface();
+    DsuContextType *ctx = 0;
+    uint64_t val = 0;
+    void *off64 = &reinterpret_cast<uint64_t *>(ctx)[idx];
+    if (off64 < &ctx->regs[DSU_GENERAL_CORE_REGS_NUM]) {
+        val = idbg->getReg(idx);
+    } else if (off64 == &ctx->pc) {
+        val = idbg->getPC();
+    } else if (off64 == &ctx->npc) {
+        val = idbg->getNPC();
+    } else if (off64 == &ctx->step_counter) {
+        val = iclk_ ? iclk_->getStepCounter() : 0;
+    } else if (off64 == &ctx->halted) {
+        val = idbg->isHalt() ? 1 : 0;
+    } else if (off64 >= &ctx->csr[0]
+        && off64 < &ctx->csr[DSU_CONTEXT_CSR_NUM]) {
+        idx = (reinterpret_cast<uint64_t>(off64)
+            - reinterpret_cast<uint64_t>(&ctx->csr)) / 8;
+        ihostio_->read(DSU_CONTEXT_CSR[idx], &val);
+    }
+    return val;
+}
+
+/**
+ * Memory is read through the system bus, so the debugger compares pages
+ * with the image without reading them back. Value ~0 marks the page that
+ * cannot be checked (no 'Bus' defined).
+ */
+uint64_t DSU::readCrc(uint64_t idx) {
+    if (!ibus_) {
+        return ~0ull;
+    }
+    uint64_t addr = crc_addr_ + idx * crc_page_;
+    if (ibus_->read(addr, crc_buf_, static_cast<int>(crc_page_)) == 0) {
+        return ~0ull;
+    }
+    return RISCV_crc32(crc_buf_, crc_page_, 0);
+}
+
+/** Entries not stored in the CPU ring are read as zeros. */
+uint64_t DSU::readTrace(uint64_t idx) {
+    ICpuRiscV *idbg = ihostio_->getCpuInterface();
+    const CpuTraceEntryType *e =
+        idbg->getTraceEntry(static_cast<unsigned>(idx / 4));
+    if (!e) {
+        return 0;
     }
+    switch (idx & 0x3) {
+    case 0:
+        return e->step;
+    case 1:
+        return e->pc;
+    case 2:
+        return e->instr;
+    default:;
+    }
+    return 0;
 }
 
 void DSU::regionControlWr(uint64_t off, Axi4TransactionType *payload) {
@@ -109,6 +237,24 @@ void DSU::regionControlWr(uint64_t off, Axi4TransactionType *payload) {
         }
     } else if (off64 == &map_->step_cnt) {
         write64(&step_cnt_, off, payload->xsize, payload->wpayload);
+    } else if (off64 == &map_->step_ctx) {
+        /**
+         * Step and context read are one request list: bus tap holds the
+         * rest of the list until the CPU is halted again.
+         */
+        bool rdy = write64(&wdata_, payload->addr, 
+                            payload->xsize, payload->wpayload);
+        if (rdy) {
+            idbg->step(wdata_);
+        }
+    } else if (off64 == &map_->crc_addr) {
+        write64(&crc_addr_, off, payload->xsize, payload->wpayload);
+    } else if (off64 == &map_->crc_page) {
+        bool rdy = write64(&wdata_, payload->addr, 
+                            payload->xsize, payload->wpayload);
+        if (rdy && wdata_ != 0 && wdata_ <= DSU_CRC_PAGE_MAX) {
+            crc_page_ = wdata_;
+        }
     } else if (off64 == &map_->add_breakpoint) {
         bool rdy = write64(&wdata_, payload->addr, 
                             payload->xsize, payload->wpayload);
@@ -121,6 +267,12 @@ void DSU::regionControlWr(uint64_t off, Axi4TransactionType *payload) {
         if (rdy) {
             idbg->removeBreakpoint(wdata_);
         }
+    } else if (off64 == &map_->speed_mode) {
+        bool rdy = write64(&wdata_, payload->addr, 
+                            payload->xsize, payload->wpayload);
+        if (rdy) {
+            idbg->setRealTime(wdata_ != 0);
+        }
     } else if (off64 >= &map_->cpu_regs[0] 
         && off64 < &map_->cpu_regs[DSU_GENERAL_CORE_REGS_NUM] ) {
         uint64_t idx = reinterpret_cast<uint64_t>(off64) 
@@ -14,10 +14,36 @@
 #include "coreservices/iwire.h"
 #include "coreservices/ihostio.h"
 #include "coreservices/icpuriscv.h"
+#include "coreservices/iclock.h"
+#include "coreservices/ibus.h"
 
 namespace debugger {
 
 static const unsigned DSU_GENERAL_CORE_REGS_NUM = 32;
+static const unsigned DSU_CONTEXT_CSR_NUM = 8;
+static const unsigned DSU_TRACE_ENTRIES_MAX = 1024;
+static const unsigned DSU_CRC_PAGES_MAX = 512;
+static const uint64_t DSU_CRC_PAGE_MAX = 64 * 1024;
+
+/** CPU state snapshot readable with one burst (read-only). */
+struct DsuContextType {
+    uint64_t regs[DSU_GENERAL_CORE_REGS_NUM];
+    uint64_t pc;
+    uint64_t npc;
+    uint64_t step_counter;      // CPU clock at the moment of reading
+    uint64_t halted;            // bit[0] = CPU halted
+    // mstatus, mtvec, mie, mip, mepc, mcause, mbadaddr, mtime
+    uint64_t csr[DSU_CONTEXT_CSR_NUM];
+    uint64_t rsv[4];
+};
+
+/** Trace buffer entry, see CpuTraceEntryType. */
+struct DsuTraceEntryType {
+    uint64_t step;
+    uint64_t pc;
+    uint64_t instr;
+    uint64_t rsv;
+};
 
 struct DsuMapType {
     uint32_t control;
@@ -25,10 +51,25 @@ struct DsuMapType {
     uint64_t step_cnt;
     uint64_t add_breakpoint;
     uint64_t remove_breakpoint;
-    uint64_t rsv2[60];
+    uint64_t speed_ratio;       // RO: sim/wall time ratio multiplied by 1000
+    uint64_t speed_mode;        // RW: 0 = max speed, 1 = real-time
+    uint64_t rsv2[58];
     uint64_t cpu_regs[DSU_GENERAL_CORE_REGS_NUM];
     uint64_t pc;
     uint64_t npc;
+    uint64_t step_ctx;          // WO: step N instructions, see context
+    uint64_t rsv3[29];
+    DsuContextType context;     // RO: offset 0x400
+    uint64_t trace_size;        // RO: trace buffer capacity (entries)
+    uint64_t trace_count;       // RO: instructions traced since start
+    uint64_t crc_addr;          // RW: address of the first CRC page
+    uint64_t crc_page;          // RW: CRC page size in bytes
+    uint64_t rsv4[332];
+    // RO: offset 0x1000, CRC-32 of page i computed on reading
+    uint64_t crc[DSU_CRC_PAGES_MAX];
+    uint64_t rsv5[3072];
+    // RO: offset 0x8000, the latest executed instruction first
+    DsuTraceEntryType trace[DSU_TRACE_ENTRIES_MAX];
 };
 
 class DSU : public IService, 
@@ -55,6 +96,9 @@ private:
     void regionCsrWr(uint64_t off, Axi4TransactionType *payload);
     void regionControlRd(uint64_t off, Axi4TransactionType *payload);
     void regionControlWr(uint64_t off, Axi4TransactionType *payload);
+    uint64_t readContext(uint64_t idx);
+    uint64_t readTrace(uint64_t idx);
+    uint64_t readCrc(uint64_t idx);
 
     void msb_of_64(uint64_t *val, uint32_t dw);
     void lsb_of_64(uint64_t *val, uint32_t dw);
@@ -67,11 +111,17 @@ private:
     AttributeType baseAddress_;
     AttributeType length_;
     AttributeType hostio_;
+    AttributeType bus_;
     IHostIO *ihostio_;
+    IBus *ibus_;
+    IClock *iclk_;
 
     DsuMapType *map_;
     uint64_t wdata_;
     uint64_t step_cnt_;
+    uint64_t crc_addr_;
+    uint64_t crc_page_;
+    uint8_t *crc_buf_;
 };
 
 DECLARE_CLASS(DSU)
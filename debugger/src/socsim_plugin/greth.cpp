@@ -15,9 +15,9 @@ REGISTER_CLASS(Greth)
 
 Greth::Greth(const char *name) 
     : IService(name) {
-    registerInterface(static_cast<IThread *>(this));
     registerInterface(static_cast<IMemoryOperation *>(this));
     registerInterface(static_cast<IClockListener *>(this));
+    registerInterface(static_cast<IRawListener *>(this));
     registerAttribute("BaseAddress", &baseAddress_);
     registerAttribute("Length", &length_);
     registerAttribute("IrqLine", &irqLine_);
@@ -37,15 +37,22 @@ Greth::Greth(const char *name)
     transport_.make_string("");
 
     memset(txbuf_, 0, sizeof(txbuf_));
+    for (int i = 0; i < GRETH_BATCH_MAX; i++) {
+        rx_items_[i].buf = rxbuf_[i];
+        rx_items_[i].size = GRETH_DATAGRAM_MAX;
+        rx_items_[i].len = 0;
+        tx_items_[i].buf = txbuf_[i];
+        tx_items_[i].size = 0;
+        tx_items_[i].len = 0;
+    }
     seq_cnt_ = 35;
-    fifo_to_ = new TFifo<FifoMessageType>(16);
-    fifo_from_ = new TFifo<FifoMessageType>(16);
-    RISCV_event_create(&event_tap_, "event_tap");
+    rx_cnt_ = 0;
+    step_pending_ = false;
+    enabled_ = false;
+    RISCV_mutex_init(&mutex_);
 }
 Greth::~Greth() {
-    delete fifo_to_;
-    delete fifo_from_;
-    RISCV_event_close(&event_tap_);
+    RISCV_mutex_destroy(&mutex_);
 }
 
 void Greth::postinitService() {
@@ -79,112 +86,108 @@ void Greth::postinitService() {
         iclk0_ = static_cast<IClock *>(clks[0u].to_iface());
     } else {
         RISCV_error("CPUs not found", NULL);
+        return;
     }
 
     // Get global settings:
     const AttributeType *glb = RISCV_get_global_settings();
     if ((*glb)["SimEnable"].to_bool()) {
-        if (!run()) {
-            RISCV_error("Can't create thread.", NULL);
-            return;
+        enabled_ = true;
+        if (itransport_->registerListener(
+                static_cast<IRawListener *>(this)) != 0) {
+            RISCV_error("Transport '%s' can't deliver datagrams",
+                        transport_.to_string());
         }
     }
 }
 
 void Greth::predeleteService() {
-    stop();
+    RISCV_mutex_lock(&mutex_);
+    enabled_ = false;
+    RISCV_mutex_unlock(&mutex_);
 }
 
-void Greth::busyLoop() {
-    int bytes;
-    UdpEdclCommonType req;
-    FifoMessageType msg;
-    RISCV_info("Ethernet thread was started", NULL);
-
-    while (isEnabled()) {
-        bytes = 
-            itransport_->readData(rxbuf_, static_cast<int>(sizeof(rxbuf_)));
-
-        if (bytes == 0) {
-            continue;
-        }
+/** Datagram is queued until the step callback of the CPU thread. */
+void Greth::updateData(const char *buf, int buflen) {
+    RISCV_mutex_lock(&mutex_);
+    if (!enabled_ || rx_cnt_ == GRETH_BATCH_MAX
+        || buflen < static_cast<int>(sizeof(UdpEdclCommonType))
+        || buflen > GRETH_DATAGRAM_MAX) {
+        // Host repeats request left without response
+        RISCV_mutex_unlock(&mutex_);
+        return;
+    }
+    memcpy(rxbuf_[rx_cnt_], buf, buflen);
+    rx_items_[rx_cnt_++].len = buflen;
+    if (!step_pending_) {
+        step_pending_ = true;
+        iclk0_->registerStepCallback(static_cast<IClockListener *>(this),
+                                     iclk0_->getStepCounter());
+    }
+    RISCV_mutex_unlock(&mutex_);
+}
 
-        req.control.word = read32(&rxbuf_[2]);
-        req.address      = read32(&rxbuf_[6]);
+/**
+ * @brief Service EDCL requests in batches.
+ * @details All queued datagrams are parsed at once, their bus accesses are
+ *          executed in this call of the CPU thread and all responses are
+ *          sent with one batch call.
+ */
+void Greth::stepCallback(uint64_t t) {
+    UdpEdclCommonType req;
+    RISCV_mutex_lock(&mutex_);
+    int cnt = rx_cnt_;
+    for (int i = 0; i < cnt; i++) {
+        req.control.word = read32(&rxbuf_[i][2]);
+        req.address      = read32(&rxbuf_[i][6]);
         if (seq_cnt_ != req.control.request.seqidx) {
-            sendNAK(&req);
+            tx_items_[i].size = formatResponse(txbuf_[i], &req, 1);
             continue;
         }
 
-        if (req.control.request.write == 0) {
-            msg.rw = 0;
-            msg.addr = req.address;
-            msg.sz = req.control.request.len;
-            msg.buf = &txbuf_[10];
-            fifo_to_->put(&msg);
-            bytes = sizeof(UdpEdclCommonType) + req.control.request.len;
-        } else {
-            msg.rw = 1;
-            msg.addr = req.address;
-            msg.sz = req.control.request.len;
-            msg.buf = &rxbuf_[10];
-            fifo_to_->put(&msg);
-            bytes = sizeof(UdpEdclCommonType);
+        // Payload is transferred by 32-bits words
+        int sz = static_cast<int>(req.control.request.len & ~0x3u);
+        if (sz && req.control.request.write == 0) {
+            ibus_->read(req.address, &txbuf_[i][10], sz);
+        } else if (sz && sz <= rx_items_[i].len - 10) {
+            ibus_->write(req.address, &rxbuf_[i][10], sz);
         }
-
-        RISCV_event_clear(&event_tap_);
-        iclk0_->registerStepCallback(static_cast<IClockListener *>(this),
-                                    iclk0_->getStepCounter());
-
-        RISCV_event_wait(&event_tap_);
-        while (!fifo_from_->isEmpty()) {
-            fifo_from_->get(&msg);
-        }
-
-        req.control.response.nak = 0;
-        req.control.response.seqidx = seq_cnt_;
-        write32(&txbuf_[2], req.control.word);
-
+        tx_items_[i].size = formatResponse(txbuf_[i], &req, 0);
         seq_cnt_++;
-        itransport_->sendData(txbuf_, bytes);
     }
-    loopEnable_ = false;
-    threadInit_.Handle = 0;
-}
+    rx_cnt_ = 0;
+    step_pending_ = false;
+    RISCV_mutex_unlock(&mutex_);
 
-void Greth::stepCallback(uint64_t t) {
-    FifoMessageType msg;
-    uint8_t *buf;
-    uint64_t addr;
-    while (!fifo_to_->isEmpty()) {
-        fifo_to_->get(&msg);
-        addr = msg.addr;
-        buf = msg.buf;
-        for (unsigned i = 0; i < msg.sz / 4u; i++) {
-            if (msg.rw == 0) {
-                ibus_->read(addr, buf, 4);
-            } else {
-                ibus_->write(addr, buf, 4);
-            }
-            buf += 4;
-            addr += 4;
-        }
-        fifo_from_->put(&msg);
+    if (cnt) {
+        itransport_->sendDataBatch(tx_items_, cnt);
     }
-    RISCV_event_set(&event_tap_);
 }
 
 void Greth::transaction(Axi4TransactionType *payload) {
 }
 
-void Greth::sendNAK(UdpEdclCommonType *req) {
-    req->control.response.nak = 1;
+/**
+ * @brief Format response header.
+ * @details ACK echoes seqidx of the executed request and read response is
+ *          followed by the data, NAK contains expected seqidx.
+ * @return Response length.
+ */
+int Greth::formatResponse(uint8_t *obuf, UdpEdclCommonType *req,
+                          uint32_t nak) {
+    int len = sizeof(UdpEdclCommonType);
+    if (nak) {
+        req->control.response.len = 0;
+    } else if (req->control.request.write == 0) {
+        len += req->control.request.len;
+    }
+    req->control.response.nak = nak;
     req->control.response.seqidx = seq_cnt_;
-    req->control.response.len = 0;
-    write32(&txbuf_[2], req->control.word);
-    write32(&txbuf_[6], req->address);
-
-    itransport_->sendData(txbuf_, sizeof(UdpEdclCommonType));
+    obuf[0] = 0;
+    obuf[1] = 0;
+    write32(&obuf[2], req->control.word);
+    write32(&obuf[6], req->address);
+    return len;
 }
 
 uint32_t Greth::read32(uint8_t *buf) {
@@ -10,7 +10,6 @@
 
 #include "iclass.h"
 #include "iservice.h"
-#include "coreservices/ithread.h"
 #include "coreservices/iclock.h"
 #include "coreservices/imemop.h"
 #include "coreservices/ibus.h"
@@ -18,7 +17,6 @@
 #include "coreservices/irawlistener.h"
 #include "coreservices/iclklistener.h"
 #include "coreservices/iwire.h"
-#include "fifo.h"
 
 namespace debugger {
 
@@ -59,10 +57,17 @@ struct UdpEdclCommonType {
 };
 #pragma pack()
 
+/**
+ * @brief EDCL server of the simulated board.
+ * @details Datagrams are delivered by the 'Transport' from the core thread
+ *          pool. All datagrams received before the CPU services the step
+ *          callback are executed and answered as one batch in the CPU
+ *          thread, so the device doesn't own a thread.
+ */
 class Greth : public IService, 
-              public IThread,
               public IMemoryOperation,
-              public IClockListener {
+              public IClockListener,
+              public IRawListener {
 public:
     Greth(const char *name);
     virtual ~Greth();
@@ -84,14 +89,13 @@ public:
     /** IClockListener */
     virtual void stepCallback(uint64_t t);
 
-protected:
-    /** IThread interface */
-    virtual void busyLoop();
+    /** IRawListener */
+    virtual void updateData(const char *buf, int buflen);
 
 private:
     void write32(uint8_t *buf, uint32_t v);
     uint32_t read32(uint8_t *buf);
-    void sendNAK(UdpEdclCommonType *req);
+    int formatResponse(uint8_t *obuf, UdpEdclCommonType *req, uint32_t nak);
 
 private:
     AttributeType baseAddress_;
@@ -108,19 +112,22 @@ private:
     IUdp *itransport_;
     IWire *iwire_;
 
-    uint8_t rxbuf_[1<<12];
-    uint8_t txbuf_[1<<12];
+    /** Datagrams of one batch, the same as EDCL max. window. */
+    static const int GRETH_BATCH_MAX = 64;
+    /** Header + payload of the maximal 10-bits length field. */
+    static const int GRETH_DATAGRAM_MAX = 2048;
+
+    uint8_t rxbuf_[GRETH_BATCH_MAX][GRETH_DATAGRAM_MAX];
+    uint8_t txbuf_[GRETH_BATCH_MAX][GRETH_DATAGRAM_MAX];
+    UdpBatchItemType rx_items_[GRETH_BATCH_MAX];
+    UdpBatchItemType tx_items_[GRETH_BATCH_MAX];
     uint32_t seq_cnt_ : 14;
 
-    struct FifoMessageType {
-        uint64_t addr;
-        uint8_t rw;
-        uint8_t *buf;
-        uint32_t sz;
-    };
-    TFifo<FifoMessageType> *fifo_to_;
-    TFifo<FifoMessageType> *fifo_from_;
-    event_def event_tap_;
+    // Received datagrams waiting for the step callback:
+    mutex_def mutex_;
+    int rx_cnt_;
+    bool step_pending_;
+    bool enabled_;
 
     greth_map regs_;
 };